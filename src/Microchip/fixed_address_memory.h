@@ -25,11 +25,13 @@ please contact mla_licensing@microchip.com
 #if(__XC8_VERSION < 2000)
 #define IN_DATA_BUFFER_ADDRESS_TAG      @0x0A0
 #define OUT_DATA_BUFFER_ADDRESS_TAG     @0x120
+#define OUT_DATA_ODD_BUFFER_ADDRESS_TAG @0x220
 #define CONTROL_BUFFER_ADDRESS_TAG      @0x1A0
     #define DRIVER_DATA_ADDRESS_TAG         @0x1A8
 #else
     #define IN_DATA_BUFFER_ADDRESS_TAG      __at(0x0A0)
     #define OUT_DATA_BUFFER_ADDRESS_TAG     __at(0x120)
+    #define OUT_DATA_ODD_BUFFER_ADDRESS_TAG __at(0x220)
     #define CONTROL_BUFFER_ADDRESS_TAG      __at(0x1A0)
     #define DRIVER_DATA_ADDRESS_TAG         __at(0x1A8)
 #endif
@@ -47,14 +47,14 @@ please contact mla_licensing@microchip.com
 
 //Make sure only one of the below "#define USB_PING_PONG_MODE"
 //is uncommented.
-#define USB_PING_PONG_MODE USB_PING_PONG__NO_PING_PONG
-//#define USB_PING_PONG_MODE USB_PING_PONG__FULL_PING_PONG
+//#define USB_PING_PONG_MODE USB_PING_PONG__NO_PING_PONG
+#define USB_PING_PONG_MODE USB_PING_PONG__FULL_PING_PONG
 //#define USB_PING_PONG_MODE USB_PING_PONG__EP0_OUT_ONLY
 //#define USB_PING_PONG_MODE USB_PING_PONG__ALL_BUT_EP0		//NOTE: This mode is not supported in PIC18F4550 family rev A3 devices
 
 
-#define USB_POLLING
-//#define USB_INTERRUPT
+//#define USB_POLLING
+#define USB_INTERRUPT
 
 /* Parameter definitions are defined in usb_device.h */
 #define USB_PULLUP_OPTION USB_PULLUP_ENABLE
@@ -151,6 +151,10 @@ please contact mla_licensing@microchip.com
 
 //#define USB_CDC_SUPPORT_HARDWARE_FLOW_CONTROL
 
+//Serial state notification reports DSR from the handler instead of a pin
+#define USB_CDC_SUPPORT_DSR_REPORTING
+#define USB_CDC_DSR_STATE_HANDLER protocol_isInputReady
+
 //Define the logic level for the "active" state.  Setting is only relevant if
 //the respective function is enabled.  Allowed options are:
 //1 = active state logic level is Vdd
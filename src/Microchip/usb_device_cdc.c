@@ -53,6 +53,7 @@ please contact mla_licensing@microchip.com
 #ifndef FIXED_ADDRESS_MEMORY
     #define IN_DATA_BUFFER_ADDRESS_TAG
     #define OUT_DATA_BUFFER_ADDRESS_TAG
+    #define OUT_DATA_ODD_BUFFER_ADDRESS_TAG
     #define CONTROL_BUFFER_ADDRESS_TAG
     #define DRIVER_DATA_ADDRESS_TAG
 #endif
@@ -64,6 +65,14 @@ please contact mla_licensing@microchip.com
 /** V A R I A B L E S ********************************************************/
 volatile unsigned char cdc_data_tx[CDC_DATA_IN_EP_SIZE] IN_DATA_BUFFER_ADDRESS_TAG;
 volatile unsigned char cdc_data_rx[CDC_DATA_OUT_EP_SIZE] OUT_DATA_BUFFER_ADDRESS_TAG;
+#if (CDC_DATA_OUT_BUFFERS > 1)
+    //Second OUT buffer is armed on the odd buffer descriptor so that the host
+    //can deliver the next packet while the previous one is being read.
+    volatile unsigned char cdc_data_rx_odd[CDC_DATA_OUT_EP_SIZE] OUT_DATA_ODD_BUFFER_ADDRESS_TAG;
+    #define CDCDataOutBuffer(index) ((index) ? cdc_data_rx_odd : cdc_data_rx)
+#else
+    #define CDCDataOutBuffer(index) (cdc_data_rx)
+#endif
 
 typedef union
 {
@@ -80,6 +89,13 @@ CDC_NOTICE cdc_notice;
     SERIAL_STATE_NOTIFICATION SerialStatePacket DRIVER_DATA_ADDRESS_TAG;
 #endif
 
+#if defined(USB_CDC_DSR_STATE_HANDLER)
+    //DSR is decided by the application (returns true when active), so there
+    //is no pin to configure
+    extern bool USB_CDC_DSR_STATE_HANDLER(void);
+    #define mInitDTSPin()
+#endif
+
 uint8_t cdc_rx_len;            // total rx length
 uint8_t cdc_trf_state;         // States are defined cdc.h
 POINTER pCDCSrc;            // Dedicated source pointer
@@ -87,10 +103,45 @@ POINTER pCDCDst;            // Dedicated destination pointer
 uint8_t cdc_tx_len;            // total tx length
 uint8_t cdc_mem_type;          // _ROM, _RAM
 
-USB_HANDLE CDCDataOutHandle;
+USB_HANDLE CDCDataOutHandle[CDC_DATA_OUT_BUFFERS];
+uint8_t CDCDataOutNext;     // OUT buffer that will complete first
 USB_HANDLE CDCDataInHandle;
 
 
+static void CDCRxArmAll(void)
+{
+    uint8_t i;
+
+    //Arms even buffer descriptor first, then odd one (if ping-pong is used)
+    for(i = 0; i < CDC_DATA_OUT_BUFFERS; i++)
+    {
+        CDCDataOutHandle[i] = USBRxOnePacket(CDC_DATA_EP,(uint8_t*)CDCDataOutBuffer(i),CDC_DATA_OUT_EP_SIZE);
+    }
+    CDCDataOutNext = 0;
+}
+
+static bool CDCRxIsOwnHandle(void *handle)
+{
+    uint8_t i;
+
+    for(i = 0; i < CDC_DATA_OUT_BUFFERS; i++)
+    {
+        if(handle == CDCDataOutHandle[i]) return true;
+    }
+    return false;
+}
+
+static bool CDCRxAnyBusy(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < CDC_DATA_OUT_BUFFERS; i++)
+    {
+        if(USBHandleBusy(CDCDataOutHandle[i])) return true;
+    }
+    return false;
+}
+
 CONTROL_SIGNAL_BITMAP control_signal_bitmap;
 uint32_t BaudRateGen;			// BRG value calculated from baud rate
 
@@ -315,7 +366,7 @@ void CDCInitEP(void)
     USBEnableEndpoint(CDC_COMM_EP,USB_IN_ENABLED|USB_HANDSHAKE_ENABLED|USB_DISALLOW_SETUP);
     USBEnableEndpoint(CDC_DATA_EP,USB_IN_ENABLED|USB_OUT_ENABLED|USB_HANDSHAKE_ENABLED|USB_DISALLOW_SETUP);
 
-    CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(uint8_t*)&cdc_data_rx,sizeof(cdc_data_rx));
+    CDCRxArmAll();
     CDCDataInHandle = NULL;
 
     #if defined(USB_CDC_SUPPORT_DSR_REPORTING)
@@ -365,6 +416,12 @@ void CDCInitEP(void)
 #if defined(USB_CDC_SUPPORT_DSR_REPORTING)
 void CDCNotificationHandler(void)
 {
+#if defined(USB_CDC_DSR_STATE_HANDLER)
+    //Ask the application for DSR state.  DCD stays active so hosts that
+    //do not use CLOCAL never see a hang-up.
+    SerialStateBitmap.bits.DCD = 1;
+    SerialStateBitmap.bits.DSR = USB_CDC_DSR_STATE_HANDLER() ? 1 : 0;
+#else
     //Check the DTS I/O pin and if a state change is detected, notify the
     //USB host by sending a serial state notification element packet.
     if(UART_DTS == USB_CDC_DSR_ACTIVE_LEVEL) //UART_DTS must be defined to be an I/O pin in the hardware profile to use the DTS feature (ex: "PORTXbits.RXY")
@@ -375,6 +432,7 @@ void CDCNotificationHandler(void)
     {
         SerialStateBitmap.bits.DSR = 0;
     }
+#endif
 
     //If the state has changed, and the endpoint is available, send a packet to
     //notify the hUSB host of the change.
@@ -426,9 +484,14 @@ bool USBCDCEventHandler(USB_EVENT event, void *pdata, uint16_t size)
     switch( (uint16_t)event )
     {
         case EVENT_TRANSFER_TERMINATED:
-            if(pdata == CDCDataOutHandle)
+            if(CDCRxIsOwnHandle(pdata))
             {
-                CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(uint8_t*)&cdc_data_rx,sizeof(cdc_data_rx));
+                //Both ping-pong buffers get terminated one after another;
+                //re-arm only once neither is owned by the SIE anymore.
+                if(!CDCRxAnyBusy())
+                {
+                    CDCRxArmAll();
+                }
             }
             if(pdata == CDCDataInHandle)
             {
@@ -484,28 +547,31 @@ bool USBCDCEventHandler(USB_EVENT event, void *pdata, uint16_t size)
   **********************************************************************************/
 uint8_t getsUSBUSART(uint8_t *buffer, uint8_t len)
 {
+    uint8_t *data;
+    uint8_t count;
+
     cdc_rx_len = 0;
 
-    if(!USBHandleBusy(CDCDataOutHandle))
+    data = peekUSBUSART(&count);
+    if(data != NULL)
     {
         /*
          * Adjust the expected number of BYTEs to equal
          * the actual number of BYTEs received.
          */
-        if(len > USBHandleGetLength(CDCDataOutHandle))
-            len = USBHandleGetLength(CDCDataOutHandle);
+        if(len > count)
+            len = count;
 
         /*
          * Copy data from dual-ram buffer to user's buffer
          */
         for(cdc_rx_len = 0; cdc_rx_len < len; cdc_rx_len++)
-            buffer[cdc_rx_len] = cdc_data_rx[cdc_rx_len];
+            buffer[cdc_rx_len] = data[cdc_rx_len];
 
         /*
          * Prepare dual-ram buffer for next OUT transaction
          */
-
-        CDCDataOutHandle = USBRxOnePacket(CDC_DATA_EP,(uint8_t*)&cdc_data_rx,sizeof(cdc_data_rx));
+        releaseUSBUSART();
 
     }//end if
 
@@ -513,6 +579,75 @@ uint8_t getsUSBUSART(uint8_t *buffer, uint8_t len)
 
 }//end getsUSBUSART
 
+/**********************************************************************************
+  Function:
+        uint8_t* peekUSBUSART(uint8_t *len)
+
+  Summary:
+    Returns the oldest received CDC Bulk OUT packet in place, without copying
+    it out of the endpoint buffer.
+
+  Description:
+    If a packet was received, a pointer to the endpoint buffer holding it is
+    returned and its length is stored to 'len' (this can be 0 for a zero
+    length packet).  The buffer stays with the caller until releaseUSBUSART()
+    is called; calling peekUSBUSART() again before that returns the same
+    packet.  With ping-pong buffering the other buffer remains armed, so the
+    host can send the next packet while this one is being parsed.
+
+  Input:
+    len -     Where the number of received BYTEs is stored.
+  Output:
+    uint8_t* -   Pointer to the received data or NULL if nothing was received.
+
+  **********************************************************************************/
+uint8_t* peekUSBUSART(uint8_t *len)
+{
+    USB_HANDLE handle;
+    uint8_t *data = NULL;
+
+    USBMaskInterrupts();
+    handle = CDCDataOutHandle[CDCDataOutNext];
+    if((handle != NULL) && !USBHandleBusy(handle))
+    {
+        *len = (uint8_t)USBHandleGetLength(handle);
+        data = (uint8_t*)CDCDataOutBuffer(CDCDataOutNext);
+    }
+    USBUnmaskInterrupts();
+
+    return data;
+}//end peekUSBUSART
+
+/**********************************************************************************
+  Function:
+        void releaseUSBUSART(void)
+
+  Summary:
+    Re-arms the endpoint buffer returned by peekUSBUSART() for the next OUT
+    transaction.
+
+  Description:
+    Once called, the pointer returned by peekUSBUSART() must not be used
+    anymore.  The stack hands out buffer descriptors in order, so the buffer
+    is always re-armed on the descriptor that just completed.  Nothing is
+    done if there is no packet being held (e.g. if endpoint was re-armed
+    after a halt in the meantime).
+
+  **********************************************************************************/
+void releaseUSBUSART(void)
+{
+    USB_HANDLE handle;
+
+    USBMaskInterrupts();
+    handle = CDCDataOutHandle[CDCDataOutNext];
+    if((handle != NULL) && !USBHandleBusy(handle))
+    {
+        CDCDataOutHandle[CDCDataOutNext] = USBRxOnePacket(CDC_DATA_EP,(uint8_t*)CDCDataOutBuffer(CDCDataOutNext),CDC_DATA_OUT_EP_SIZE);
+        CDCDataOutNext = (CDCDataOutNext + 1) % CDC_DATA_OUT_BUFFERS;
+    }
+    USBUnmaskInterrupts();
+}//end releaseUSBUSART
+
 /******************************************************************************
   Function:
 	void putUSBUSART(char *data, uint8_t length)
@@ -96,6 +96,13 @@ please contact mla_licensing@microchip.com
 #define CDC_TX_BUSY_ZLP             2       // ZLP: Zero Length Packet
 #define CDC_TX_COMPLETING           3
 
+/* CDC Bulk OUT buffers (two when data endpoint is ping-pong buffered) */
+#if (USB_PING_PONG_MODE == USB_PING_PONG__FULL_PING_PONG) || (USB_PING_PONG_MODE == USB_PING_PONG__ALL_BUT_EP0)
+    #define CDC_DATA_OUT_BUFFERS    2
+#else
+    #define CDC_DATA_OUT_BUFFERS    1
+#endif
+
 #if defined(USB_CDC_SET_LINE_CODING_HANDLER)
     #define LINE_CODING_TARGET &cdc_notice.SetLineCoding._byte[0]
     #define LINE_CODING_PFUNC &USB_CDC_SET_LINE_CODING_HANDLER
@@ -652,6 +659,49 @@ bool USBCDCEventHandler(USB_EVENT event, void *pdata, uint16_t size);
   **********************************************************************************/
 uint8_t getsUSBUSART(uint8_t *buffer, uint8_t len);
 
+/**********************************************************************************
+  Function:
+        uint8_t* peekUSBUSART(uint8_t *len)
+
+  Summary:
+    Returns the oldest received CDC Bulk OUT packet in place, without copying
+    it out of the endpoint buffer.
+
+  Description:
+    If a packet was received, a pointer to the endpoint buffer holding it is
+    returned and its length is stored to 'len' (this can be 0 for a zero
+    length packet).  The buffer stays with the caller until releaseUSBUSART()
+    is called.
+
+    Typical Usage:
+    <code>
+        uint8_t numBytes;
+        uint8_t *data = peekUSBUSART(&numBytes);
+        if(data != NULL)
+        {
+            //parse numBytes bytes directly from data
+            releaseUSBUSART();
+        }
+    </code>
+  Input:
+    len -     Where the number of received BYTEs is stored.
+  Output:
+    uint8_t* -   Pointer to the received data or NULL if nothing was received.
+
+  **********************************************************************************/
+uint8_t* peekUSBUSART(uint8_t *len);
+
+/**********************************************************************************
+  Function:
+        void releaseUSBUSART(void)
+
+  Summary:
+    Re-arms the endpoint buffer returned by peekUSBUSART() for the next OUT
+    transaction.
+
+  **********************************************************************************/
+void releaseUSBUSART(void);
+
 /******************************************************************************
   Function:
 	void putUSBUSART(char *data, uint8_t length)
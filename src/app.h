@@ -7,12 +7,28 @@
 
 // I2C_MASTER
 #define _I2C_MASTER_CUSTOM_INIT
+#define _I2C_MASTER_TIMEOUT_TICKS  32  // about 1 ms
+
+// SPI_MASTER
+#define _SPI_MASTER_TIMEOUT_TICKS  32  // about 1 ms
 
 // SSD1306
 #define _SSD1306_CUSTOM_INIT
+#define _SSD1306_DISPLAY_COUNT  2
+#define _SSD1306_TRANSPORT_SPI
 #define _SSD1306_CONTROL_DISPLAY
 #define _SSD1306_CONTROL_INVERT
 #define _SSD1306_CONTROL_FLIP
+#define _SSD1306_CONTROL_ROTATE
+#define _SSD1306_CONTROL_SCROLL
+#define _SSD1306_CONTROL_ZOOM
 #define _SSD1306_CONTROL_CONTRAST
 #define _SSD1306_FONT_8x8
+#define _SSD1306_FONT_8x8_LOW
+#define _SSD1306_FONT_8x8_HIGH
 #define _SSD1306_FONT_8x16
+#define _SSD1306_FONT_3x5
+#define _SSD1306_WRITE_SCALED
+#define _SSD1306_WRITE_SHIFTED
+#define _SSD1306_WRITE_PROPORTIONAL
+#define _SSD1306_WRITE_ATTRIBUTES
@@ -1,7 +1,33 @@
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include "buffer.h"
 
+uint8_t BufferArena[BUFFER_ARENA_SIZE];
+uint8_t BufferArenaNextBlock = BUFFER_ARENA_USED / BUFFER_BLOCK_SIZE;  // first block not lent yet
+
+uint8_t InputBufferCount = 0;
+bool InputBufferCorrupted = false;
+
+volatile uint8_t OutputBufferHead = 0;
+volatile uint8_t OutputBufferTail = 0;
+
+uint8_t DrawQueueStart = 0;
+uint8_t DrawQueueCount = 0;
+
+
+uint8_t* buffer_take(const uint8_t blockCount) {
+    if (blockCount > buffer_getFreeBlocks()) { return NULL; }
+    uint8_t* block = &BufferArena[(uint16_t)BufferArenaNextBlock * BUFFER_BLOCK_SIZE];
+    BufferArenaNextBlock += blockCount;
+    return block;
+}
+
+uint8_t buffer_getFreeBlocks(void) {
+    return BUFFER_ARENA_BLOCKS - BufferArenaNextBlock;
+}
+
+
 void buffer_copy(uint8_t* destination, const uint8_t* source, const uint8_t count) {
     for (uint8_t i = 0; i < count ; i++) {
         *destination = *source;
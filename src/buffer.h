@@ -1,29 +1,66 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "Microchip/usb_config.h"
 
-// USB read buffer
-#define USB_READ_BUFFER_MAX  CDC_DATA_IN_EP_SIZE
-uint8_t UsbReadBuffer[USB_READ_BUFFER_MAX];
+// Buffer arena - queues are carved from it at build time; remaining blocks are lent at run time
+#define BUFFER_BLOCK_SIZE    16
+#define BUFFER_ARENA_BLOCKS  37  // queues take 20; screen record and marquee text take the rest
+#define BUFFER_ARENA_SIZE    (BUFFER_ARENA_BLOCKS * BUFFER_BLOCK_SIZE)
+extern uint8_t BufferArena[BUFFER_ARENA_SIZE];
 
-// USB write buffer
-#define USB_WRITE_BUFFER_MAX  CDC_DATA_OUT_EP_SIZE
-uint8_t UsbWriteBuffer[USB_WRITE_BUFFER_MAX];
+
+// USB packets are read in place from the OUT endpoint buffer (ping-pong buffered)
+#define USB_READ_BUFFER_MAX  CDC_DATA_OUT_EP_SIZE
 
 
 // Input buffer - max is maximum line length
 #define INPUT_BUFFER_MAX  192
-uint8_t InputBuffer[INPUT_BUFFER_MAX];
-uint8_t InputBufferCount = 0;
-bool InputBufferCorrupted = false;
+#define INPUT_BUFFER_HIGH  (INPUT_BUFFER_MAX - USB_READ_BUFFER_MAX)  // DSR is dropped once another packet won't fit
+#define INPUT_BUFFER_LOW   64                                       // DSR is raised again
+#define INPUT_BUFFER_OFFSET  0
+#define InputBuffer  (&BufferArena[INPUT_BUFFER_OFFSET])
+extern uint8_t InputBufferCount;
+extern bool InputBufferCorrupted;
+
+// Output ring - head is written only by main loop, tail only by USB service (size must be power of 2)
+#define OUTPUT_BUFFER_MAX 64
+#define OUTPUT_BUFFER_HIGH 24  // new line waits below it; each command also waits until its reply fits
+#define OUTPUT_BUFFER_OFFSET  (INPUT_BUFFER_OFFSET + INPUT_BUFFER_MAX)
+#define OutputBuffer  (&BufferArena[OUTPUT_BUFFER_OFFSET])
+extern volatile uint8_t OutputBufferHead;
+extern volatile uint8_t OutputBufferTail;
+
+#define OutputBufferCount()  ((uint8_t)(OutputBufferHead - OutputBufferTail))
+#define OutputBufferAppend(X)  OutputBuffer[OutputBufferHead & (OUTPUT_BUFFER_MAX - 1)] = (X); OutputBufferHead++;
+
+
+// Draw queue - operations waiting to be rendered (size must be power of 2)
+#define DRAW_QUEUE_MAX  64
+#define DRAW_QUEUE_OFFSET  (OUTPUT_BUFFER_OFFSET + OUTPUT_BUFFER_MAX)
+#define DrawQueue  (&BufferArena[DRAW_QUEUE_OFFSET])
+extern uint8_t DrawQueueStart;
+extern uint8_t DrawQueueCount;
+
+#define DrawQueueAppend(X)  DrawQueue[(DrawQueueStart + DrawQueueCount) & (DRAW_QUEUE_MAX - 1)] = (X); DrawQueueCount++;
+
+
+// RAM budget - checked at build time
+#define BUFFER_ARENA_USED  (DRAW_QUEUE_OFFSET + DRAW_QUEUE_MAX)  // carved by queues above
+#if (INPUT_BUFFER_MAX % BUFFER_BLOCK_SIZE) || (OUTPUT_BUFFER_MAX % BUFFER_BLOCK_SIZE) || (DRAW_QUEUE_MAX % BUFFER_BLOCK_SIZE)
+    #error "Buffer sizes must be whole arena blocks"
+#endif
+#if (BUFFER_ARENA_USED > BUFFER_ARENA_SIZE)
+    #error "Buffer arena is too small for queues"
+#endif
+
 
-// Output buffer - max needs to be on a large size to prevent running out of it
-#define OUTPUT_BUFFER_MAX 224
-#define OUTPUT_BUFFER_HIGH 192
-uint8_t OutputBuffer[OUTPUT_BUFFER_MAX];
-uint8_t OutputBufferCount = 0;
+/** Lends given number of unused arena blocks for the rest of run time. Returns NULL if there are not enough left. */
+uint8_t* buffer_take(const uint8_t blockCount);
 
-#define OutputBufferAppend(X)  OutputBuffer[OutputBufferCount] = (X); OutputBufferCount++;
+/** Returns number of arena blocks that can still be lent. */
+uint8_t buffer_getFreeBlocks(void);
 
 
 void buffer_copy(uint8_t* destination, const uint8_t* source, const uint8_t count);
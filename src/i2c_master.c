@@ -2,26 +2,60 @@
 
 #include <xc.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "app.h"
+#include "i2c_master.h"
 
-void i2c_master_16f_start(void) {
-    SSPCON2bits.SEN = 1;      // initiate Start condition
-    while (SSPCON2bits.SEN);  // wait until done
+#if defined(_I2C_MASTER_TIMEOUT_TICKS)
+    #include "system.h"  // getTicks
+    #define i2c_master_16f_timerStart()                getTicks()
+    #define i2c_master_16f_timerExpired(startTicks)    ((uint16_t)(getTicks() - (startTicks)) >= _I2C_MASTER_TIMEOUT_TICKS)
+#else
+    #define i2c_master_16f_timerStart()                0
+    #define i2c_master_16f_timerExpired(startTicks)    false
+#endif
+
+bool i2c_master_16f_busFault;  // set on timeout or collision; bus needs recovery before next use
+
+bool i2c_master_16f_fault(void) {
+    i2c_master_16f_busFault = true;
+    return false;
+}
+
+bool i2c_master_16f_start(void) {
+    SSPCON2bits.SEN = 1;                                  // initiate Start condition
+    uint16_t startTicks = i2c_master_16f_timerStart();
+    while (SSPCON2bits.SEN) {                             // wait until done
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
+    return true;
 }
 
-void i2c_master_16f_restart(void) {
-    SSPCON2bits.RSEN = 1;      // initiate Repeated Start condition
-    while (SSPCON2bits.RSEN);  // wait until done
+bool i2c_master_16f_restart(void) {
+    SSPCON2bits.RSEN = 1;                                 // initiate Repeated Start condition
+    uint16_t startTicks = i2c_master_16f_timerStart();
+    while (SSPCON2bits.RSEN) {                            // wait until done
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
+    return true;
 }
 
-void i2c_master_16f_stop(void) {
-    SSPCON2bits.PEN = 1;      // initiate Stop condition
-    while (SSPCON2bits.PEN);  // wait until done
+bool i2c_master_16f_stop(void) {
+    SSPCON2bits.PEN = 1;                                  // initiate Stop condition
+    uint16_t startTicks = i2c_master_16f_timerStart();
+    while (SSPCON2bits.PEN) {                             // wait until done
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
+    return true;
 }
 
-void i2c_master_16f_waitIdle(void) {
-    while ((SSPCON2 & 0x1F) | SSPSTATbits.R_nW);  // wait until idle
+bool i2c_master_16f_waitIdle(void) {
+    uint16_t startTicks = i2c_master_16f_timerStart();
+    while ((SSPCON2 & 0x1F) | SSPSTATbits.R_nW) {        // wait until idle
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
+    return true;
 }
 
 void i2c_master_16f_resetBus(void) {
@@ -40,31 +74,47 @@ void i2c_master_16f_resetBus(void) {
 }
 
 bool i2c_master_16f_writeByte(const uint8_t value) {
-    i2c_master_16f_waitIdle();
-    SSPBUF = value;                             // set data
-    if (SSPCON1bits.WCOL) { return false; }     // fail if there is a collision
-    while (SSPSTATbits.BF);                     // wait until write is done
-    return SSPCON2bits.ACKSTAT ? false : true;  // return if successful
+    if (!i2c_master_16f_waitIdle()) { return false; }
+    SSPBUF = value;                                       // set data
+    if (SSPCON1bits.WCOL || PIR2bits.BCL1IF) {            // fail if there is a collision
+        SSPCON1bits.WCOL = 0;
+        PIR2bits.BCL1IF = 0;
+        return i2c_master_16f_fault();
+    }
+    uint16_t startTicks = i2c_master_16f_timerStart();
+    while (SSPSTATbits.BF) {                              // wait until write is done
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
+    return SSPCON2bits.ACKSTAT ? false : true;            // return if successful
 }
 
 bool i2c_master_16f_startWrite(const uint8_t address) {
-    i2c_master_16f_waitIdle();
-    i2c_master_16f_start();                                    // start operation
+    if (!i2c_master_16f_waitIdle()) { return false; }
+    if (!i2c_master_16f_start()) { return false; }                // start operation
     return i2c_master_16f_writeByte((uint8_t)(address << 1));  // load address
 }
 
 bool i2c_master_16f_readByte(uint8_t* value) {
-    if (PIR2bits.BCL1IF) { return false; }
+    if (PIR2bits.BCL1IF) {
+        PIR2bits.BCL1IF = 0;
+        return i2c_master_16f_fault();
+    }
 
     SSPCON2bits.RCEN = 1;                       // start receive
-    while ( !SSPSTATbits.BF );                  // wait for byte
+    uint16_t startTicks = i2c_master_16f_timerStart();
+    while (!SSPSTATbits.BF) {                   // wait for byte
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
 
     *value = SSPBUF;                             // read byte
     if (SSPCON2bits.ACKSTAT) { return false; }  // end prematurely if there's an error
 
     SSPCON2bits.ACKDT = 0;                      // ACK byte
     SSPCON2bits.ACKEN = 1;                      // initiate acknowledge sequence
-    while (SSPCON2bits.ACKEN);                  // wait for done
+    startTicks = i2c_master_16f_timerStart();
+    while (SSPCON2bits.ACKEN) {                 // wait for done
+        if (i2c_master_16f_timerExpired(startTicks)) { return i2c_master_16f_fault(); }
+    }
 
     return true;                                 // return success
 }
@@ -103,44 +153,63 @@ void i2c_master_setup(const uint8_t baudRateCounter) {
 #endif
 
 
-bool i2c_master_readRegisterBytes(const uint8_t deviceAddress, const uint8_t registerAddress, uint8_t* readData, const uint8_t readCount) {
+bool i2c_master_16f_finish(const bool wasOk, const bool canRetry) {  // returns true if operation should be retried
+    if (wasOk) { return false; }
+    if (!i2c_master_16f_busFault) {  // not acknowledged; bus is still fine
+        i2c_master_16f_stop();
+        if (!i2c_master_16f_busFault) { return false; }
+    }
+    i2c_master_setup(SSP1ADD);  // stuck bus or collision; recover at the same speed
+    i2c_master_16f_busFault = false;
+    return canRetry;
+}
+
+
+bool i2c_master_16f_readRegister(const uint8_t deviceAddress, const uint8_t registerAddress, uint8_t* readData, const uint8_t readCount) {
     if (!i2c_master_16f_startWrite(deviceAddress)) { return false; }
     if (!i2c_master_16f_writeByte(registerAddress)) { return false; }
 
-    i2c_master_16f_restart();
+    if (!i2c_master_16f_restart()) { return false; }
     for (uint8_t i = 0; i < readCount; i++) {
         if (!i2c_master_16f_readByte(readData)) { return false; }
         readData++;
     }
 
-    i2c_master_16f_stop();
-    return true;
+    return i2c_master_16f_stop();
 }
 
+bool i2c_master_readRegisterBytes(const uint8_t deviceAddress, const uint8_t registerAddress, uint8_t* readData, const uint8_t readCount) {
+    for (uint8_t attempt = 1; ; attempt++) {
+        bool wasOk = i2c_master_16f_readRegister(deviceAddress, registerAddress, readData, readCount);
+        if (!i2c_master_16f_finish(wasOk, attempt < _I2C_MASTER_ATTEMPTS)) { return wasOk; }
+    }
+}
 
-bool i2c_master_writeRegisterBytes(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t* data, const uint8_t count) {
+
+bool i2c_master_16f_writeRegister(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t* data, const uint8_t count) {  // data of NULL writes zeros
     if (!i2c_master_16f_startWrite(deviceAddress)) { return false; }
 
     if (!i2c_master_16f_writeByte(registerAddress)) { return false; }
     for (uint8_t i = 0; i < count; i++) {
-        if (!i2c_master_16f_writeByte(*data)) { return false; }
-        data++;
+        if (!i2c_master_16f_writeByte((data != NULL) ? *data : 0)) { return false; }
+        if (data != NULL) { data++; }
     }
 
-    i2c_master_16f_stop();
-    return true;
+    return i2c_master_16f_stop();
 }
 
-bool i2c_master_writeRegisterZeroBytes(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t zeroCount) {
-    if (!i2c_master_16f_startWrite(deviceAddress)) { return false; }
-
-    if (!i2c_master_16f_writeByte(registerAddress)) { return false; }
-    for (uint8_t i = 0; i < zeroCount; i++) {
-        if (!i2c_master_16f_writeByte(0)) { return false; }
+bool i2c_master_writeRegisterBytes(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t* data, const uint8_t count) {
+    for (uint8_t attempt = 1; ; attempt++) {
+        bool wasOk = i2c_master_16f_writeRegister(deviceAddress, registerAddress, data, count);
+        if (!i2c_master_16f_finish(wasOk, attempt < _I2C_MASTER_ATTEMPTS)) { return wasOk; }
     }
+}
 
-    i2c_master_16f_stop();
-    return true;
+bool i2c_master_writeRegisterZeroBytes(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t zeroCount) {
+    for (uint8_t attempt = 1; ; attempt++) {
+        bool wasOk = i2c_master_16f_writeRegister(deviceAddress, registerAddress, NULL, zeroCount);
+        if (!i2c_master_16f_finish(wasOk, attempt < _I2C_MASTER_ATTEMPTS)) { return wasOk; }
+    }
 }
 
 
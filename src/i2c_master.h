@@ -1,4 +1,5 @@
 /* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+// 2024-11-08: Added timeouts and bus recovery
 // 2024-10-13: Added higher speed modes
 // 2024-09-23: Initial version
 
@@ -6,11 +7,16 @@
  * Handling I2C master communication
  *
  * Defines used:
- *   _I2C_MASTER_RATE_KHZ <value>: If used, sets I2C speed to defined value
- *   _I2C_MASTER_CUSTOM_INIT:      If set, allows for custom speed initialization
+ *   _I2C_MASTER_RATE_KHZ <value>:  If used, sets I2C speed to defined value
+ *   _I2C_MASTER_CUSTOM_INIT:       If set, allows for custom speed initialization
+ *   _I2C_MASTER_TIMEOUT_TICKS <N>: If used, limits each wait to N getTicks() ticks
+ *   _I2C_MASTER_ATTEMPTS <N>:      Attempts when bus fails; default is 2
  *
  * Notes:
  *   Both CLOCK and DATA pin has to be configured as input
+ *   Transfer that is not acknowledged is stopped and never retried
+ *   Timeout or collision resets the bus (about 3 ms) before the next attempt
+ *   Writing N bytes has 2N+7 waits; with timeouts each attempt is bounded
  */
 
 #pragma once
@@ -23,6 +29,12 @@
     #error "Cannot have both custom and rate defined"
 #endif
 
+#if !defined(_I2C_MASTER_ATTEMPTS)
+    #define _I2C_MASTER_ATTEMPTS  2
+#elif (_I2C_MASTER_ATTEMPTS < 1)
+    #error "I2C attempts must be at least 1"
+#endif
+
 #if defined(_I2C_MASTER_CUSTOM_INIT)
     /** Initializes I2C as a master; rate is in 10 kHz */
     void i2c_master_init(uint8_t rate);
@@ -1,4 +1,6 @@
 #include <xc.h>
+#include <stdint.h>
+#include "io.h"
 
 void io_init(void) {
     LATA4 = 0;  // active is always off (open-drain))
@@ -7,3 +9,20 @@ void io_init(void) {
     LATC4 = 0;  // turn on by default (just for compatibility with I2C boards, pullup is always present on Oled FEC)
     TRISC4 = 0;
 }
+
+void io_spi_init(void) {  // I2C-only boards keep these pins as inputs
+    LATC3 = 0;  // SPI data/command
+    TRISC3 = 0;
+    LATC5 = 1;  // SPI chip select for even devices (inactive)
+    TRISC5 = 0;
+    LATA5 = 1;  // SPI chip select for odd devices (inactive)
+    TRISA5 = 0;
+}
+
+void io_spi_select(const uint8_t device) {
+    if (device & 0x01) {
+        LATA5 = 0;
+    } else {
+        LATC5 = 0;
+    }
+}
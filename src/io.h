@@ -1,6 +1,7 @@
 #pragma once
 
 #include <xc.h>
+#include <stdint.h>
 
 
 void io_init(void);
@@ -11,3 +12,13 @@ void io_init(void);
 
 #define io_pullup_on()             LC4 = 0
 #define io_pullup_off()            LC4 = 1
+
+#define io_spi_command()           LATC3 = 0
+#define io_spi_data()              LATC3 = 1
+#define io_spi_deselect()          do { LATC5 = 1; LATA5 = 1; } while (0)
+
+/** Drives SPI data/command and chip select pins; until then they are left as inputs. */
+void io_spi_init(void);
+
+/** Selects SPI chip (RC5 if device is even, RA5 if odd). */
+void io_spi_select(const uint8_t device);
@@ -0,0 +1,111 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "buffer.h"
+#include "marquee.h"
+#include "screen.h"
+#include "ssd1306.h"
+#include "system.h"
+
+#define MARQUEE_TEXT_BLOCKS   ((MARQUEE_TEXT_MAX + BUFFER_BLOCK_SIZE - 1) / BUFFER_BLOCK_SIZE)
+#define MARQUEE_SECOND_TICKS  ((uint16_t)TICKS_PER_MS * 1000)
+#define MARQUEE_WIDTH         128  // pixel columns of the row
+#define MARQUEE_CHUNK         16   // pixel columns redrawn at once when controller cannot scroll content
+
+uint8_t* MarqueeText = NULL;
+uint8_t MarqueeCount = 0;   // 0 if not scrolling
+uint8_t MarqueeRow;
+#if defined(_SSD1306_CONTROL_CONTENT_SCROLL)
+    uint8_t MarqueeIndex;   // character fed next
+    uint8_t MarqueeColumn;  // its pixel column fed next
+#else
+    uint16_t MarqueeOffset; // text columns that went in so far, counting blank ones before text (wraps once text went in fully)
+    uint8_t MarqueeChunk;   // pixel column of the row redrawn next; 0 once the whole row is shown
+#endif
+uint16_t MarqueeStepTicks;  // time between columns
+uint16_t MarqueeTicks;      // last column
+
+
+void marquee_init(void) {
+    if (MarqueeText == NULL) {  // arena blocks are lent only once
+        MarqueeText = buffer_take(MARQUEE_TEXT_BLOCKS);  // nothing scrolls without them
+    }
+    MarqueeCount = 0;
+}
+
+bool marquee_start(const uint8_t row, const uint8_t speed, const uint8_t* text, const uint8_t count) {
+    if ((MarqueeText == NULL) || (count == 0) || (count > MARQUEE_TEXT_MAX)) { return false; }
+    if ((row == 0) || (row > 8) || (speed == 0) || (speed > 9)) { return false; }  // content scroll page is only 3 bits
+    for (uint8_t i = 0; i < count; i++) {
+        if ((text[i] < 32) || (text[i] > 126)) { return false; }
+    }
+
+    uint8_t cursorRow = ssd1306_getRow();
+    uint8_t cursorColumn = ssd1306_getColumn();
+    if (!ssd1306_clearRow(row)) { return false; }  // row doesn't exist
+    ssd1306_moveTo(cursorRow, cursorColumn);
+    screen_forgetArea(row, 1, 1, SCREEN_COLUMNS);
+
+    buffer_copy(MarqueeText, text, count);
+    MarqueeCount = count;
+    MarqueeRow = row;
+    #if defined(_SSD1306_CONTROL_CONTENT_SCROLL)
+        MarqueeIndex = 0;
+        MarqueeColumn = 0;
+    #else
+        MarqueeOffset = 0;
+        MarqueeChunk = 0;
+    #endif
+    MarqueeStepTicks = MARQUEE_SECOND_TICKS / (uint8_t)(speed * 10);
+    MarqueeTicks = getTicks();
+    return true;
+}
+
+void marquee_stop(void) {
+    MarqueeCount = 0;
+}
+
+#if defined(_SSD1306_CONTROL_CONTENT_SCROLL)
+    bool marquee_process(void) {  // controller moves the row; only the new column is sent
+        if (MarqueeCount == 0) { return false; }
+        if ((uint16_t)(getTicks() - MarqueeTicks) < MarqueeStepTicks) { return false; }
+        MarqueeTicks = getTicks();  // late columns are not caught up with
+
+        uint8_t data = ssd1306_getCharacter((char)MarqueeText[MarqueeIndex])[MarqueeColumn];
+        MarqueeColumn++;
+        if (MarqueeColumn == 8) {
+            MarqueeColumn = 0;
+            MarqueeIndex++;
+            if (MarqueeIndex == MarqueeCount) { MarqueeIndex = 0; }
+        }
+        screen_forgetRows(MarqueeRow, 1);  // even if row was cleared since
+        return ssd1306_scrollRowLeft(MarqueeRow, data);
+    }
+#else
+    bool marquee_process(void) {  // whole row is redrawn one chunk per call so USB is not kept waiting
+        if (MarqueeCount == 0) { return false; }
+        if (MarqueeChunk == 0) {
+            if ((uint16_t)(getTicks() - MarqueeTicks) < MarqueeStepTicks) { return false; }
+            MarqueeTicks = getTicks();  // late columns are not caught up with
+            uint16_t textColumns = (uint16_t)MarqueeCount << 3;
+            MarqueeOffset++;
+            if (MarqueeOffset >= MARQUEE_WIDTH + textColumns) { MarqueeOffset -= textColumns; }  // same view as one text length before
+        }
+
+        uint8_t data[MARQUEE_CHUNK];
+        uint16_t column = MarqueeOffset + MarqueeChunk;  // column of blank lead-in followed by repeating text
+        for (uint8_t i = 0; i < MARQUEE_CHUNK; i++) {
+            if (column < MARQUEE_WIDTH) {
+                data[i] = 0;
+            } else {
+                uint16_t textColumn = (column - MARQUEE_WIDTH) % ((uint16_t)MarqueeCount << 3);
+                data[i] = ssd1306_getCharacter((char)MarqueeText[textColumn >> 3])[textColumn & 0x07];
+            }
+            column++;
+        }
+        bool ok = ssd1306_writeRowPixels(MarqueeRow, MarqueeChunk, data, MARQUEE_CHUNK);
+        MarqueeChunk = (MarqueeChunk + MARQUEE_CHUNK) % MARQUEE_WIDTH;
+        screen_forgetRows(MarqueeRow, 1);  // even if row was cleared since
+        return ok;
+    }
+#endif
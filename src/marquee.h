@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Marquee - text moved through a single row one pixel column at a time
+#define MARQUEE_TEXT_MAX  32
+
+
+/** Takes text memory from buffer arena and stops scrolling. */
+void marquee_init(void);
+
+/** Clears given row (starting from 1, up to 8) of the selected display and starts scrolling printable ASCII text through it from the right at speed 1 (10 pixels per second) to 9 (90 pixels per second). Text repeats until stopped. */
+bool marquee_start(const uint8_t row, const uint8_t speed, const uint8_t* text, const uint8_t count);
+
+/** Stops scrolling; row keeps what it shows. */
+void marquee_stop(void);
+
+/** Feeds the next pixel column into the row once it is due. Returns false if nothing was written. */
+bool marquee_process(void);
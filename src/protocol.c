@@ -0,0 +1,1221 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+#include "i2c_master.h"
+#include "marquee.h"
+#include "protocol.h"
+#include "screen.h"
+#include "settings.h"
+#include "spi_master.h"
+#include "ssd1306.h"
+#include "stats.h"
+#include "system.h"
+#include "utf8.h"
+
+bool processInput(void);  // parses a single unit of the current line; returns false if there is nothing to do
+bool queueCommand(const uint8_t* data, const uint8_t count);
+bool processCommand(const uint8_t* data, const uint8_t count);
+bool render(void);  // renders a single queued operation; returns false if there is nothing to do
+void initOled(void);
+void probeI2CSpeed(void);
+void adjustI2CSpeed(void);
+void collectI2CErrors(void);
+void watchDisplay(void);
+void restoreDisplay(void);
+void initDisplay(const uint8_t display);
+void setupDisplay(const uint8_t display);
+void initSelectedDisplay(void);
+void resetScreen(void);
+void resumeMirror(void);
+uint8_t nibbleToHex(const uint8_t value);
+void appendHex16(const uint16_t value);
+bool hexToNibble(const uint8_t hex, uint8_t* nibble);
+
+#define PROTOCOL_SLICE_TICKS  TICKS_PER_MS  // how long to process input before returning to USB
+
+#define I2C_SECOND_TICKS        (TICKS_PER_MS * 1000)
+#define I2C_PROBE_COUNT         8    // no-op commands that must all be acknowledged for speed to be used
+#define I2C_QUIET_SECONDS_MIN   10   // how long without errors before trying the next faster speed
+#define I2C_QUIET_SECONDS_MAX   160  // each back off doubles the wait up to this
+
+#define DISPLAY_WATCH_TICKS  (TICKS_PER_MS * 100)  // how often selected display is probed
+
+#define DRAW_OP_CLEAR       0x07  // clear screen
+#define DRAW_OP_HOME        0x08  // move to origin
+#define DRAW_OP_NEXT_ROW    0x0A  // move to the next row
+#define DRAW_OP_CLEAR_REST  0x0C  // clear remaining
+#define DRAW_OP_FONT_SMALL  0x0E  // characters that follow are 8x8
+#define DRAW_OP_FONT_LARGE  0x0F  // characters that follow are 8x16
+#define DRAW_OP_MOVE        0x10  // followed by row and column
+#define DRAW_OP_GLYPH       0x11  // followed by 8 bytes
+#define DRAW_OP_GLYPH16     0x12  // followed by 16 bytes
+#define DRAW_OP_INVERT      0x13  // display invert
+#define DRAW_OP_NORMAL      0x14  // display normal
+#define DRAW_OP_SCALED      0x15  // followed by scale, count, and characters
+#define DRAW_OP_SHIFT       0x16  // followed by pixels 8x8 characters are moved down
+#define DRAW_OP_MOVE_PIXEL  0x17  // followed by pixel column
+#define DRAW_OP_TEXT        0x18  // followed by count and characters written proportionally
+#define DRAW_OP_MINI_TEXT   0x19  // followed by count and 3x5 characters
+#define DRAW_OP_CHARACTER   0x1A  // followed by character below 32
+#define DRAW_OP_ATTRIBUTES  0x1B  // followed by attributes for characters that follow
+#define DRAW_OP_MAX_LENGTH  17    // longest operation; other values are characters
+
+#define COMMAND_REPLY_MAX  (4 + SCREEN_ROWS * 4 + 1 + 2)  // screen hash of all rows followed by mark of rows not covered, error mark and EOL
+
+#define TEXT_COMMAND_MAX  40                        // longest proportional or mini text command
+#define TEXT_OP_MAX       (DRAW_OP_MAX_LENGTH - 2)  // longer text is split
+
+#if (SETTINGS_DISPLAY_COUNT != _SSD1306_DISPLAY_COUNT)
+    #error Settings must exist for each display
+#endif
+
+bool LastUseLarge = false;
+
+uint8_t InputLineEnd = 0;  // count of bytes belonging to complete lines
+bool InputReady = true;    // watermark state; only touched from USB service
+
+bool LineActive = false;   // line is being processed
+uint8_t LineLength;        // line length without EOL
+uint8_t LinePosition;      // next character to process
+bool LineUseLarge;
+uint8_t LineAttributes;    // reset once line is done
+bool LineWasOk;
+
+uint8_t CursorRow;         // where cursor will be once queue is rendered
+uint8_t CursorColumn;
+uint8_t CursorPixel;       // same rules as ssd1306_getPixel
+bool QueuedUseLarge = false;  // font used by queued characters
+
+bool DrawUseLarge = false;
+uint8_t DrawShift = 0;
+uint8_t DrawClearRow = 0;  // next row to clear; 0 if not clearing
+
+uint8_t DisplayMirror = 0;  // displays that get a copy of selected display's output
+
+uint8_t I2CSpeedIndex;                                 // speed currently used; never above the one in settings
+uint8_t I2CQuietSeconds;                               // seconds without errors at the current speed
+uint8_t I2CQuietSecondsNeeded = I2C_QUIET_SECONDS_MIN;
+uint16_t I2CQuietTicks;                                // start of the current second
+bool I2CFailed = false;                                // write failed since the last command that waited for rendering
+
+bool DisplayLost = false;  // selected display stopped acknowledging; redrawn once it answers again
+uint16_t DisplayWatchTicks;
+
+
+void syncCursor(void) {
+    CursorRow = ssd1306_getRow();
+    CursorColumn = ssd1306_getColumn();
+    CursorPixel = ssd1306_getPixel();
+}
+
+uint8_t getRowCount(void) {  // text rows of the selected display
+    uint8_t display = ssd1306_getDisplay();
+    if (settings_getDisplayRotate(display)) { return 16; }  // display is always 128 pixels wide
+    if (ssd1306_isZoomed()) { return settings_getDisplayHeight(display) >> 4; }  // each row is shown twice as high
+    return settings_getDisplayHeight(display) >> 3;
+}
+
+uint8_t getColumnCount(void) {  // text columns of the selected display
+    uint8_t display = ssd1306_getDisplay();
+    if (settings_getDisplayRotate(display)) { return settings_getDisplayHeight(display) >> 3; }
+    return 16;  // display is always 128 pixels wide
+}
+
+uint8_t getCursorPixel(void) {  // same rules as ssd1306_getPixel
+    if ((uint8_t)(((CursorPixel + 7) >> 3) + 1) == CursorColumn) { return CursorPixel; }
+    return (uint8_t)((CursorColumn - 1) << 3);
+}
+
+void protocol_init(void) {
+    LastUseLarge = false;
+    LineActive = false;
+    DrawQueueCount = 0;
+    DrawClearRow = 0;
+    DrawUseLarge = false;
+    DrawShift = 0;
+    QueuedUseLarge = false;
+    DisplayMirror = 0;
+    ssd1306_setAttributes(0);
+    ssd1306_selectDisplay(0);
+    screen_init();
+    marquee_init();
+    initOled();
+    syncCursor();
+}
+
+
+bool protocol_canReceive(void) {
+    if (InputLineEnd == 0) { return true; }  // nothing waiting; line either fits or it is lost anyhow
+    return (INPUT_BUFFER_MAX - InputBufferCount) >= USB_READ_BUFFER_MAX;
+}
+
+bool protocol_isInputReady(void) {
+    if (InputReady) {
+        if ((InputLineEnd > 0) && (InputBufferCount >= INPUT_BUFFER_HIGH)) { InputReady = false; }  // only when lines are waiting; otherwise rest of the line would never come
+    } else {
+        if ((InputLineEnd == 0) || (InputBufferCount <= INPUT_BUFFER_LOW)) { InputReady = true; }
+    }
+    return InputReady;
+}
+
+bool protocol_receive(const uint8_t* data, const uint8_t count) {
+    bool wasOk = true;
+    for (uint8_t i = 0; i < count; i++) {  // copy to buffer
+        uint8_t value = data[i];
+        if (InputBufferCorrupted && ((value == 0x0A) || (value == 0x0D))) {
+            InputBufferCount = InputLineEnd;  // clear the whole incomplete line
+            InputBufferCorrupted = false;
+        } else if (InputBufferCount < INPUT_BUFFER_MAX) {
+            InputBuffer[InputBufferCount] = value;
+            InputBufferCount++;
+            if ((value == 0x0A) || (value == 0x0D)) { InputLineEnd = InputBufferCount; }
+        } else {
+            InputBufferCorrupted = true;  // no more buffer; darn it
+            wasOk = false;
+        }
+    }
+    return wasOk;
+}
+
+
+void protocol_process(void) {
+    adjustI2CSpeed();
+    watchDisplay();
+    if (!DisplayLost) { marquee_process(); }
+    uint16_t startTicks = getTicks();
+    do {
+        if (!processInput()) {  // parsing first so lines get acknowledged as soon as possible
+            if (!render()) { return; }
+        }
+    } while ((uint16_t)(getTicks() - startTicks) < PROTOCOL_SLICE_TICKS);
+}
+
+bool protocol_isRendered(void) {
+    return (DrawQueueCount == 0) && (DrawClearRow == 0);
+}
+
+
+void queueFont(const bool useLarge) {
+    if (QueuedUseLarge != useLarge) {
+        DrawQueueAppend(useLarge ? DRAW_OP_FONT_LARGE : DRAW_OP_FONT_SMALL);
+        QueuedUseLarge = useLarge;
+    }
+}
+
+void queueNextRow(void) {  // same rules as ssd1306_moveToNextRow
+    if (CursorRow < getRowCount()) {
+        CursorRow++;
+        CursorColumn = 1;
+    }
+    DrawQueueAppend(DRAW_OP_NEXT_ROW);
+}
+
+bool queueMove(const uint8_t row, const uint8_t column) {  // same rules as ssd1306_moveTo
+    if ((row > getRowCount()) || (column > getColumnCount())) { return false; }
+    if (row != 0) { CursorRow = row; }
+    if (column != 0) { CursorColumn = column; }
+    CursorPixel = (uint8_t)((CursorColumn - 1) << 3);
+    DrawQueueAppend(DRAW_OP_MOVE);
+    DrawQueueAppend(row);
+    DrawQueueAppend(column);
+    return true;
+}
+
+bool queueCharacter(const uint8_t value) {
+    if (CursorColumn > getColumnCount()) { return false; }  // same as when character would be drawn
+    queueFont(LineUseLarge);
+    if (value < 32) { DrawQueueAppend(DRAW_OP_CHARACTER); }  // would be taken for operation otherwise
+    DrawQueueAppend(value);
+    CursorColumn++;
+    return true;
+}
+
+void queueText(const uint8_t op, const uint8_t* text, uint8_t count, const uint8_t opCountMax) {  // text is split into operations of at most opCountMax characters
+    while (count > 0) {
+        uint8_t opCount = (count > opCountMax) ? opCountMax : count;
+        DrawQueueAppend(op);
+        DrawQueueAppend(opCount);
+        for (uint8_t i = 0; i < opCount; i++) {
+            DrawQueueAppend(*text++);
+        }
+        count -= opCount;
+    }
+}
+
+void finishLine(void) {
+    if (!LineWasOk) {
+        OutputBufferAppend('!');  // if there's any error, return exclamation point
+    }
+    OutputBufferAppend(InputBuffer[LineLength]);  // same EOL as received
+
+    uint8_t lineCount = LineLength + 1;  // move unused portion of buffer to the start
+    InputBufferCount -= lineCount;
+    InputLineEnd -= lineCount;
+    buffer_copy(&InputBuffer[0], &InputBuffer[lineCount], InputBufferCount);
+    LineActive = false;
+}
+
+
+uint8_t takeDrawQueue(void) {
+    uint8_t value = DrawQueue[DrawQueueStart];
+    DrawQueueStart = (DrawQueueStart + 1) & (DRAW_QUEUE_MAX - 1);
+    DrawQueueCount--;
+    return value;
+}
+
+void renderShifted(const uint8_t* data) {  // pixels around come from the screen record
+    uint8_t row = ssd1306_getRow();
+    uint8_t column = ssd1306_getColumn();
+    uint8_t above[8];
+    uint8_t below[8];
+    screen_getCell(row, column, above);
+    screen_getCell(row + 1, column, below);
+    screen_forgetArea(row, column, 2, 1);
+    ssd1306_drawCustomShifted(data, DrawShift, above, below);
+}
+
+void renderCharacter(const uint8_t value) {
+    if (DrawUseLarge) {
+        screen_putCharacter(ssd1306_getRow(), ssd1306_getColumn(), value, true);
+        ssd1306_writeCharacter16(value);
+    } else if (DrawShift != 0) {
+        renderShifted(ssd1306_getCharacter(value));
+    } else {
+        screen_putCharacter(ssd1306_getRow(), ssd1306_getColumn(), value, false);
+        ssd1306_writeCharacter(value);
+    }
+}
+
+bool render(void) {
+    if (DrawClearRow != 0) {  // clear screen, one row at a time
+        ssd1306_clearRow(DrawClearRow);
+        DrawClearRow++;
+        if (DrawClearRow > getRowCount()) {
+            DrawClearRow = 0;
+            ssd1306_moveTo(1, 1);
+        }
+        return true;
+    }
+
+    if (DrawQueueCount == 0) { return false; }
+
+    uint8_t op = takeDrawQueue();
+    switch (op) {
+        case DRAW_OP_CLEAR:
+            DrawClearRow = 1;
+            screen_clear();
+            marquee_stop();
+            ssd1306_scrollStop();
+            break;
+
+        case DRAW_OP_HOME:
+            ssd1306_moveTo(1, 1);
+            break;
+
+        case DRAW_OP_NEXT_ROW:
+            ssd1306_moveToNextRow();
+            break;
+
+        case DRAW_OP_CLEAR_REST:
+            screen_clearRest(ssd1306_getRow(), ssd1306_getColumn(), DrawUseLarge);
+            if (DrawUseLarge) {
+                ssd1306_clearRemaining16();
+            } else {
+                ssd1306_clearRemaining();
+            }
+            break;
+
+        case DRAW_OP_FONT_SMALL:
+            DrawUseLarge = false;
+            break;
+
+        case DRAW_OP_FONT_LARGE:
+            DrawUseLarge = true;
+            break;
+
+        case DRAW_OP_MOVE: {
+            uint8_t row = takeDrawQueue();
+            uint8_t column = takeDrawQueue();
+            ssd1306_moveTo(row, column);
+        } break;
+
+        case DRAW_OP_GLYPH:
+        case DRAW_OP_GLYPH16: {
+            uint8_t dataCount = (op == DRAW_OP_GLYPH16) ? 16 : 8;
+            uint8_t customCharData[16];
+            for (uint8_t i = 0; i < dataCount; i++) {
+                customCharData[i] = takeDrawQueue();
+            }
+            if (dataCount == 16) {
+                screen_putGlyph(ssd1306_getRow(), ssd1306_getColumn(), &customCharData[0], true);
+                ssd1306_drawCustom16(&customCharData[0]);
+            } else if (DrawShift != 0) {
+                renderShifted(&customCharData[0]);
+            } else {
+                screen_putGlyph(ssd1306_getRow(), ssd1306_getColumn(), &customCharData[0], false);
+                ssd1306_drawCustom(&customCharData[0]);
+            }
+        } break;
+
+        case DRAW_OP_INVERT:
+            screen_setInverse(true);
+            ssd1306_displayInvert();
+            break;
+
+        case DRAW_OP_NORMAL:
+            screen_setInverse(false);
+            ssd1306_displayNormal();
+            break;
+
+        case DRAW_OP_SCALED: {
+            uint8_t scale = takeDrawQueue();
+            uint8_t count = takeDrawQueue();
+            screen_forgetArea(ssd1306_getRow(), ssd1306_getColumn(), scale, (uint8_t)(scale * count));
+            for (uint8_t i = 0; i < count; i++) {
+                ssd1306_writeCharacterScaled((char)takeDrawQueue(), scale);
+            }
+        } break;
+
+        case DRAW_OP_SHIFT:
+            DrawShift = takeDrawQueue();
+            break;
+
+        case DRAW_OP_MOVE_PIXEL:
+            ssd1306_moveToPixel(0, takeDrawQueue());
+            break;
+
+        case DRAW_OP_MINI_TEXT: {
+            uint8_t count = takeDrawQueue();
+            screen_forgetArea(ssd1306_getRow(), ssd1306_getColumn(), 1, (uint8_t)((count + 1) >> 1));
+            while (count > 0) {
+                char left = (char)takeDrawQueue();
+                char right = ' ';
+                if (count > 1) { right = (char)takeDrawQueue(); count--; }
+                ssd1306_writeMiniCharacters(left, right);
+                count--;
+            }
+        } break;
+
+        case DRAW_OP_TEXT: {
+            uint8_t count = takeDrawQueue();
+            char text[TEXT_OP_MAX + 1];
+            for (uint8_t i = 0; i < count; i++) {
+                text[i] = (char)takeDrawQueue();
+            }
+            text[count] = 0;
+            uint8_t firstColumn = ssd1306_getPixel() >> 3;
+            if (ssd1306_writeProportionalText(text)) {
+                uint8_t endColumn = (uint8_t)((ssd1306_getPixel() + 7) >> 3);
+                screen_forgetArea(ssd1306_getRow(), firstColumn + 1, 1, endColumn - firstColumn);
+            }
+        } break;
+
+        case DRAW_OP_CHARACTER:
+            renderCharacter(takeDrawQueue());
+            break;
+
+        case DRAW_OP_ATTRIBUTES:
+            ssd1306_setAttributes(takeDrawQueue());
+            break;
+
+        default:
+            renderCharacter(op);
+            break;
+    }
+
+    return true;
+}
+
+
+void setI2CSpeed(const uint8_t speedIndex) {  // with SPI, index is in MHz
+    if (settings_getUseSpi()) {
+        spi_master_init(speedIndex);
+    } else {
+        switch (speedIndex) {
+            case 2: i2c_master_init(20); break;    // 200 kHz @ 48 MHz
+            case 3: i2c_master_init(30); break;    // 300 kHz @ 48 MHz
+            case 4: i2c_master_init(40); break;    // 400 kHz @ 48 MHz
+            case 5: i2c_master_init(50); break;    // 500 kHz @ 48 MHz
+            case 6: i2c_master_init(60); break;    // 600 kHz @ 48 MHz
+            case 7: i2c_master_init(70); break;    // 700 kHz @ 48 MHz (~705 kHz)
+            case 8: i2c_master_init(80); break;    // 800 kHz @ 48 MHz
+            case 9: i2c_master_init(90); break;    // 900 kHz @ 48 MHz (~923 kHz)
+            case 10: i2c_master_init(100); break;  // 1000 kHz @ 48 MHz
+            default: i2c_master_init(10); break;   // 100 kHz @ 48 MHz
+        }
+    }
+    I2CSpeedIndex = speedIndex;
+    I2CQuietSeconds = 0;
+    I2CQuietTicks = getTicks();
+}
+
+void probeI2CSpeed(void) {  // steps down from the speed in settings until the selected display acknowledges every probe
+    uint8_t address = settings_getI2CAddress(ssd1306_getDisplay());
+    for (uint8_t speedIndex = settings_getI2CSpeedIndex(); speedIndex > 1; speedIndex--) {
+        setI2CSpeed(speedIndex);
+        bool ok = true;
+        for (uint8_t i = 0; i < I2C_PROBE_COUNT; i++) {
+            ok &= ssd1306_probe(address);
+        }
+        if (ok) { return; }
+    }
+    setI2CSpeed(1);
+}
+
+void collectI2CErrors(void) {  // backs off on write errors
+    uint8_t mirrorLost = ssd1306_takeMirrorLost();
+    if (mirrorLost != 0) {  // mirror is dropped instead of slowing down the bus for the selected display
+        DisplayMirror &= (uint8_t)~mirrorLost;
+        I2CFailed = true;
+    }
+
+    uint8_t errorCount = ssd1306_takeErrorCount();
+    if (errorCount == 0) { return; }
+
+    stats_i2cFailed(errorCount);
+    I2CFailed = true;
+    if (DisplayLost) { return; }  // slowing down won't bring it back
+    if (I2CSpeedIndex > 1) {
+        setI2CSpeed(I2CSpeedIndex - 1);
+        if (I2CQuietSecondsNeeded < I2C_QUIET_SECONDS_MAX) { I2CQuietSecondsNeeded <<= 1; }
+    }
+    I2CQuietSeconds = 0;
+    I2CQuietTicks = getTicks();
+    if (!ssd1306_probe(settings_getI2CAddress(ssd1306_getDisplay()))) { DisplayLost = true; }  // not even at slower speed
+}
+
+void adjustI2CSpeed(void) {  // tries faster speed again once it has been quiet
+    collectI2CErrors();
+    if ((uint16_t)(getTicks() - I2CQuietTicks) < I2C_SECOND_TICKS) { return; }
+    I2CQuietTicks += I2C_SECOND_TICKS;
+    if (I2CQuietSeconds < 0xFF) { I2CQuietSeconds++; }
+
+    if ((I2CQuietSeconds >= I2CQuietSecondsNeeded) && (I2CSpeedIndex < settings_getI2CSpeedIndex())) {
+        setI2CSpeed(I2CSpeedIndex + 1);
+    }
+}
+
+
+void watchDisplay(void) {  // probes selected display and restores it once it answers again
+    if ((uint16_t)(getTicks() - DisplayWatchTicks) < DISPLAY_WATCH_TICKS) { return; }
+    DisplayWatchTicks = getTicks();
+    if (!ssd1306_probe(settings_getI2CAddress(ssd1306_getDisplay()))) {
+        DisplayLost = true;
+    } else if (DisplayLost) {
+        restoreDisplay();
+    }
+}
+
+void restoreDisplay(void) {  // display came back uninitialized (reconnected or browned out)
+    uint8_t display = ssd1306_getDisplay();
+    uint8_t row = ssd1306_getRow();
+    uint8_t column = ssd1306_getColumn();
+    bool zoomed = ssd1306_isZoomed();  // might differ from settings
+    DisplayLost = false;
+    I2CQuietSecondsNeeded = I2C_QUIET_SECONDS_MIN;  // errors were not caused by speed
+    probeI2CSpeed();
+    ssd1306_setMirror(0);
+    setupDisplay(display);
+    ssd1306_displayZoom(zoomed);
+    screen_setScrolling(0, 0);  // not restored
+    stats_displayRestored(!screen_isComplete(getRowCount(), getColumnCount()));
+    screen_redraw(getRowCount(), getColumnCount(), row, column);
+    resumeMirror();
+    ssd1306_takeErrorCount();  // display that is gone again will be noticed by the next probe
+}
+
+
+void initOled(void) {
+    ssd1306_setTransport(settings_getUseSpi() ? SSD1306_TRANSPORT_SPI : SSD1306_TRANSPORT_I2C);
+    probeI2CSpeed();
+
+    uint8_t selectedDisplay = ssd1306_getDisplay();
+    for (uint8_t i = 0; i < SETTINGS_DISPLAY_COUNT; i++) {
+        ssd1306_selectDisplay(i);
+        initDisplay(i);
+    }
+    ssd1306_selectDisplay(selectedDisplay);
+    resumeMirror();
+    ssd1306_takeErrorCount();  // display that is not connected is no reason to slow down
+    resetScreen();
+}
+
+void initDisplay(const uint8_t display) {
+    setupDisplay(display);
+    ssd1306_writeText16("    USB OLED    ");
+    ssd1306_moveToNextRow16();
+    ssd1306_writeText("   medo64.com   ");
+    ssd1306_moveToNextRow();
+}
+
+void setupDisplay(const uint8_t display) {  // blank display with settings applied
+    ssd1306_init(settings_getI2CAddress(display), 128, settings_getDisplayHeight(display));
+    ssd1306_setContrast(settings_getDisplayBrightness(display));
+    if (settings_getDisplayInverse(display)) {
+        ssd1306_displayInvert();
+    } else {
+        ssd1306_displayNormal();
+    }
+    ssd1306_displayRotate(settings_getDisplayRotate(display));
+    ssd1306_displayFlip(settings_getDisplayFlip(display));
+    ssd1306_displayZoom(settings_getDisplayZoom(display));
+    ssd1306_clearAll();
+}
+
+void initSelectedDisplay(void) {  // settings are per display so mirrors are left alone
+    ssd1306_setMirror(0);
+    initDisplay(ssd1306_getDisplay());
+    resumeMirror();
+    ssd1306_takeErrorCount();  // display that is not connected is no reason to slow down
+    resetScreen();
+}
+
+void resetScreen(void) {  // splash screen is not recorded
+    screen_clear();
+    marquee_stop();  // row belonged to the display that was set up
+    screen_setInverse(settings_getDisplayInverse(ssd1306_getDisplay()));
+    DisplayLost = false;
+}
+
+void resumeMirror(void) {  // mirror that no longer matches selected display is dropped
+    if (!ssd1306_setMirror(DisplayMirror)) { DisplayMirror = 0; }
+}
+
+
+bool processInput(void) {
+    if (!LineActive) {
+        if (InputLineEnd == 0) { return false; }  // no complete line
+        if (OutputBufferCount() >= OUTPUT_BUFFER_HIGH) { return false; }  // wait for host to read responses
+
+        uint8_t eolIndex = 0;
+        while ((InputBuffer[eolIndex] != 0x0A) && (InputBuffer[eolIndex] != 0x0D)) { eolIndex++; }
+        LineActive = true;
+        LineLength = eolIndex;
+        LinePosition = 0;
+        LineUseLarge = false;
+        LineAttributes = 0;
+        LineWasOk = true;
+        utf8_reset();
+        return true;
+    }
+
+    if ((DRAW_QUEUE_MAX - DrawQueueCount) < DRAW_OP_MAX_LENGTH) { return false; }  // wait for queue to drain
+
+    if (LineLength == 0) {  // if line is empty, process it more
+        queueNextRow();
+        if (LastUseLarge) {  // extra move for large font
+            queueNextRow();
+            LastUseLarge = false;
+        }
+        finishLine();
+        return true;
+    }
+
+    if (LinePosition >= LineLength) {
+        if (LineAttributes != 0) {  // attributes never carry to the next line
+            DrawQueueAppend(DRAW_OP_ATTRIBUTES);
+            DrawQueueAppend(0);
+        }
+        LastUseLarge = LineUseLarge;
+        finishLine();
+        return true;
+    }
+
+    uint8_t* data = &InputBuffer[LinePosition];
+    switch (*data) {
+        case 0x07:  // BEL: clear screen
+            DrawQueueAppend(DRAW_OP_CLEAR);
+            CursorRow = 1; CursorColumn = 1;
+            break;
+
+        case 0x08:  // BS: move to origin
+            DrawQueueAppend(DRAW_OP_HOME);
+            CursorRow = 1; CursorColumn = 1;
+            break;
+
+        case 0x09: {  // HT: command mode
+            uint8_t* cmdData = data + 1;
+            uint8_t cmdIndex = LineLength;
+            for (uint8_t j = LinePosition + 1; j < LineLength; j++) {
+                if (*cmdData == 0) {
+                    cmdIndex = j;
+                    break;
+                }
+                cmdData++;
+            }
+            uint8_t cmdCount = cmdIndex - LinePosition - 1;
+            if (cmdCount > 0) {
+                switch (*++data) {
+                    case 'c': case 'C': case 'i': case 'I': case 'm': case 'n': case 'x': case 'y':  // drawing is queued
+                        LineWasOk &= queueCommand(data, cmdCount);
+                        break;
+
+                    case 'p': case 's':  // text can take more than the longest operation
+                        if ((cmdCount <= TEXT_COMMAND_MAX + 1) && ((DRAW_QUEUE_MAX - DrawQueueCount) < cmdCount + 5)) { return false; }
+                        LineWasOk &= queueCommand(data, cmdCount);
+                        break;
+
+                    default:  // everything else waits for rendering to complete
+                        if (!protocol_isRendered()) { return false; }
+                        if ((OUTPUT_BUFFER_MAX - OutputBufferCount()) < COMMAND_REPLY_MAX) { return false; }  // line can have more than one command; wait for host to read replies
+                        if (*data != '.') {  // flush has nothing else to do
+                            LineWasOk &= processCommand(data, cmdCount);
+                            syncCursor();
+                        }
+                        collectI2CErrors();
+                        LineWasOk &= !I2CFailed;  // includes rendering of earlier lines
+                        I2CFailed = false;
+                        break;
+                }
+            }
+            LinePosition = cmdIndex;
+        } break;
+
+        case 0x0B:  // VT: double-size font
+            LineUseLarge = !LineUseLarge;
+            break;
+
+        case 0x0C:  // FF: clear remaining
+            queueFont(LineUseLarge);
+            DrawQueueAppend(DRAW_OP_CLEAR_REST);
+            break;
+
+        case 0x1B: {  // ESC: attribute toggle
+            uint8_t attribute = 0;
+            if (LinePosition + 1 < LineLength) {
+                LinePosition++;
+                switch (data[1]) {
+                    case '0': attribute = LineAttributes; break;  // all off
+                    case 'i': attribute = SSD1306_ATTRIBUTE_INVERSE; break;
+                    case 'b': attribute = SSD1306_ATTRIBUTE_BOLD; break;
+                    case 'u': attribute = SSD1306_ATTRIBUTE_UNDERLINE; break;
+                    case 's': attribute = SSD1306_ATTRIBUTE_STRIKE; break;
+                    default: LineWasOk = false; break;
+                }
+            } else {
+                LineWasOk = false;
+            }
+            if (attribute != 0) {
+                LineAttributes ^= attribute;
+                DrawQueueAppend(DRAW_OP_ATTRIBUTES);
+                DrawQueueAppend(LineAttributes);
+            }
+        } break;
+
+        default: {
+            uint16_t codePoint;
+            if (utf8_decode(*data, &codePoint) && (codePoint >= 32) && (codePoint != 127)) {  // ignore ASCII control characters
+                LineWasOk &= queueCharacter(utf8_toCp437(codePoint));
+            }
+        } break;
+    }
+
+    LinePosition++;
+    return true;
+}
+
+bool queueCommand(const uint8_t* data, const uint8_t count) {
+    if (settings_getDisplayRotate(ssd1306_getDisplay())) {  // scaled, proportional, and shifted writes are never rotated
+        if ((*data == 'n') || (*data == 'p') || (*data == 'x') || (*data == 'y')) { return false; }
+    }
+
+    switch (*data) {
+
+        case 'c':
+        case 'C':
+            if ((count == 17) || (count == 33)) {
+                if (CursorColumn > getColumnCount()) { return false; }
+                uint8_t dataCount = (count - 1) >> 1;
+                uint8_t index = DrawQueueStart + DrawQueueCount + 1;  // data is committed only if it is all valid
+                for (uint8_t i = 0; i < dataCount; i++) {
+                    uint8_t* customCharData = &DrawQueue[index & (DRAW_QUEUE_MAX - 1)];
+                    if (!hexToNibble(*++data, customCharData)) { return false; }
+                    if (!hexToNibble(*++data, customCharData)) { return false; }
+                    index++;
+                }
+                DrawQueueAppend((dataCount == 16) ? DRAW_OP_GLYPH16 : DRAW_OP_GLYPH);
+                DrawQueueCount += dataCount;
+                CursorColumn++;
+                return true;
+            }
+            break;
+
+        case 'i':
+            if (count == 1) {
+                DrawQueueAppend(DRAW_OP_INVERT);
+                return true;
+            }
+            break;
+
+        case 'I':
+            if (count == 1) {
+                DrawQueueAppend(DRAW_OP_NORMAL);
+                return true;
+            }
+            break;
+
+        case 'm':
+            if (count == 3) {
+                uint8_t row = 0;
+                if (!hexToNibble(*++data, &row)) { return false; }
+                if (!hexToNibble(*++data, &row)) { return false; }
+                return queueMove(row, 1);
+            } else if (count == 5) {
+                uint8_t row = 0, column = 0;
+                if (!hexToNibble(*++data, &row)) { return false; }
+                if (!hexToNibble(*++data, &row)) { return false; }
+                if (!hexToNibble(*++data, &column)) { return false; }
+                if (!hexToNibble(*++data, &column)) { return false; }
+                return queueMove(row, column);
+            }
+            break;
+
+        case 'n':
+            if (count >= 3) {
+                uint8_t scale = data[1] - '0';
+                uint8_t textCount = count - 2;
+                if ((scale < 2) || (scale > 4)) { return false; }
+                if ((uint8_t)(CursorRow + scale - 1) > getRowCount()) { return false; }
+                if ((uint16_t)CursorColumn + scale * textCount - 1 > getColumnCount()) { return false; }
+                for (uint8_t i = 0; i < textCount; i++) {
+                    if ((data[i + 2] < 32) || (data[i + 2] > 126)) { return false; }
+                }
+                DrawQueueAppend(DRAW_OP_SCALED);
+                DrawQueueAppend(scale);
+                DrawQueueAppend(textCount);
+                for (uint8_t i = 0; i < textCount; i++) {
+                    DrawQueueAppend(data[i + 2]);
+                }
+                CursorColumn += (uint8_t)(scale * textCount);
+                return true;
+            }
+            break;
+
+        case 's':
+            if ((count >= 2) && (count <= TEXT_COMMAND_MAX + 1)) {
+                const uint8_t* text = data + 1;
+                uint8_t textCount = count - 1;
+                uint8_t columnCount = (uint8_t)((textCount + 1) >> 1);
+                if ((uint8_t)(CursorColumn + columnCount - 1) > getColumnCount()) { return false; }
+                for (uint8_t i = 0; i < textCount; i++) {
+                    if ((text[i] < 32) || (text[i] > 126)) { return false; }
+                }
+                queueText(DRAW_OP_MINI_TEXT, text, textCount, TEXT_OP_MAX & 0xFE);  // pairs are never split
+                CursorColumn += columnCount;
+                return true;
+            }
+            break;
+
+        case 'x':
+            if (count == 3) {
+                uint8_t x = 0;
+                if (!hexToNibble(*++data, &x)) { return false; }
+                if (!hexToNibble(*++data, &x)) { return false; }
+                if (x >= (getColumnCount() << 3)) { return false; }
+                DrawQueueAppend(DRAW_OP_MOVE_PIXEL);
+                DrawQueueAppend(x);
+                CursorPixel = x;
+                CursorColumn = (uint8_t)(((x + 7) >> 3) + 1);
+                return true;
+            }
+            break;
+
+        case 'p':
+            if ((count >= 2) && (count <= TEXT_COMMAND_MAX + 1)) {
+                const uint8_t* text = data + 1;
+                uint8_t textCount = count - 1;
+                uint16_t width = getCursorPixel();
+                for (uint8_t i = 0; i < textCount; i++) {
+                    if ((text[i] < 32) || (text[i] > 126)) { return false; }
+                    width += ssd1306_getCharacterWidth((char)text[i]);
+                }
+                if (width > (getColumnCount() << 3)) { return false; }
+                queueText(DRAW_OP_TEXT, text, textCount, TEXT_OP_MAX);
+                CursorPixel = (uint8_t)width;
+                CursorColumn = (uint8_t)(((width + 7) >> 3) + 1);
+                return true;
+            }
+            break;
+
+        case 'y':
+            if ((count == 2) && (data[1] >= '0') && (data[1] <= '7')) {
+                DrawQueueAppend(DRAW_OP_SHIFT);
+                DrawQueueAppend(data[1] - '0');
+                return true;
+            }
+            break;
+
+    }
+
+    return false;
+}
+
+bool processCommand(const uint8_t* data, const uint8_t count) {
+    uint8_t display = ssd1306_getDisplay();
+    switch (*data) {
+
+        case '#':  // screen size
+            if (count == 1) {  // get screen size
+                uint8_t height = settings_getDisplayHeight(display);
+                if (height == 128) {
+                    OutputBufferAppend('C');
+                } else if (height == 32) {
+                    OutputBufferAppend('B');
+                } else {
+                    OutputBufferAppend('A');
+                }
+                return true;
+            } else if (count == 2) {  // set screen size
+                switch(*++data) {
+                    case 'A': case 'a': settings_setDisplayHeight(display, 64); break;
+                    case 'B': case 'b': settings_setDisplayHeight(display, 32); break;
+                    case 'C': case 'c': settings_setDisplayHeight(display, 128); break;
+                    default: return false;
+                }
+                settings_save();
+                initSelectedDisplay();
+                return true;
+            }
+            break;
+
+        case '$':  // inverse
+            if (count == 1) {  // get if display is inverted by default
+                if (settings_getDisplayInverse(display)) {
+                    OutputBufferAppend('I');
+                } else {
+                    OutputBufferAppend('N');
+                }
+                return true;
+            } else if (count == 2) {  // set if display is inverted
+                switch(*++data) {
+                    case 'I': settings_setDisplayInverse(display, true); break;
+                    case 'N': settings_setDisplayInverse(display, false); break;
+                    default: return false;
+                }
+                settings_save();
+                initSelectedDisplay();
+                return true;
+            }
+            break;
+
+        case '=':  // flip and rotation
+            if (count == 1) {  // get display orientation
+                if (settings_getDisplayRotate(display)) {
+                    OutputBufferAppend(settings_getDisplayFlip(display) ? 'L' : 'R');
+                } else {
+                    OutputBufferAppend(settings_getDisplayFlip(display) ? 'F' : 'N');
+                }
+                return true;
+            } else if (count == 2) {  // set display orientation
+                bool rotate, flip;
+                switch(*++data) {
+                    case 'N': rotate = false; flip = false; break;
+                    case 'F': rotate = false; flip = true; break;
+                    case 'R': rotate = true; flip = false; break;
+                    case 'L': rotate = true; flip = true; break;
+                    default: return false;
+                }
+                settings_setDisplayRotate(display, rotate);
+                settings_setDisplayFlip(display, flip);
+                settings_save();
+                initSelectedDisplay();
+                return true;
+            }
+            break;
+
+        case '+':  // zoom
+            if (count == 1) {  // get if display is zoomed by default
+                OutputBufferAppend(settings_getDisplayZoom(display) ? 'Z' : 'N');
+                return true;
+            } else if (count == 2) {  // set if display is zoomed
+                bool zoom;
+                switch(*++data) {
+                    case 'Z': zoom = true; break;
+                    case 'N': zoom = false; break;
+                    default: return false;
+                }
+                if (zoom && ((settings_getDisplayHeight(display) != 64) || settings_getDisplayRotate(display))) { return false; }  // same limits as display has
+                settings_setDisplayZoom(display, zoom);
+                settings_save();
+                initSelectedDisplay();
+                return true;
+            }
+            break;
+
+        case ':':  // select display
+            if (count == 1) {  // get selected display followed by mirrored ones
+                OutputBufferAppend('1' + display);
+                for (uint8_t i = 0; i < SETTINGS_DISPLAY_COUNT; i++) {
+                    if (DisplayMirror & (1 << i)) { OutputBufferAppend('1' + i); }
+                }
+                return true;
+            } else if (count <= SETTINGS_DISPLAY_COUNT + 1) {  // select display and optionally displays to mirror
+                uint8_t mirror = 0;
+                for (uint8_t i = 1; i < count; i++) {
+                    uint8_t index = data[i] - '1';
+                    if (index >= SETTINGS_DISPLAY_COUNT) { return false; }
+                    mirror |= (uint8_t)(1 << index);
+                }
+                bool isChanged = (display != (uint8_t)(data[1] - '1'));
+                display = data[1] - '1';
+                DisplayMirror = mirror & (uint8_t)~(1 << display);
+                ssd1306_selectDisplay(display);
+                if (isChanged) { resetScreen(); }  // content of the other display is not known
+                if (!ssd1306_setMirror(DisplayMirror)) {  // mirror of other size, rotation, or zoom would get garbled content
+                    DisplayMirror = 0;
+                    return false;
+                }
+                return true;
+            }
+            break;
+
+        case 'z':  // zoom in
+            if (count == 1) {
+                return ssd1306_displayZoom(true);
+            }
+            break;
+
+        case 'Z':  // zoom cancel
+            if (count == 1) {
+                return ssd1306_displayZoom(false);
+            }
+            break;
+
+        case 'h':  // hardware scroll
+            if (count == 1) {  // stop scrolling
+                screen_setScrolling(0, 0);
+                return ssd1306_scrollStop();
+            } else if (count == 7) {  // scroll rows at given speed in given direction
+                uint8_t firstRow = 0, lastRow = 0;
+                if (!hexToNibble(data[1], &firstRow)) { return false; }
+                if (!hexToNibble(data[2], &firstRow)) { return false; }
+                if (!hexToNibble(data[3], &lastRow)) { return false; }
+                if (!hexToNibble(data[4], &lastRow)) { return false; }
+                bool left;
+                switch (data[6]) {
+                    case 'L': left = true; break;
+                    case 'R': left = false; break;
+                    default: return false;
+                }
+                if (!ssd1306_scrollStart(firstRow, lastRow, data[5] - '0', left)) { return false; }
+                screen_setScrolling(firstRow, lastRow);
+                return true;
+            }
+            break;
+
+        case 't':  // ticker
+            if (count == 1) {  // stop ticker
+                marquee_stop();
+                return true;
+            } else if (count >= 3) {  // scroll text through the current row
+                if (settings_getDisplayRotate(display)) { return false; }  // columns are fed only along display width
+                return marquee_start(CursorRow, data[1] - '0', data + 2, count - 2);
+            }
+            break;
+
+        case '%':  // reset
+            if (count == 1) {  // reboot
+                reset();
+                return true;
+            }
+            break;
+
+        case '*':  // brightness
+            if (count == 1) {  // get brightness
+                uint8_t brightness = settings_getDisplayBrightness(display);
+                OutputBufferAppend(nibbleToHex(brightness >> 4));  // high nibble
+                OutputBufferAppend(nibbleToHex(brightness));  // low nibble
+                return true;
+            } else if (count == 3) {  // set brightness
+                uint8_t brightness = 0;
+                if (!hexToNibble(*++data, &brightness)) { return false; }
+                if (!hexToNibble(*++data, &brightness)) { return false; }
+                settings_setDisplayBrightness(display, brightness);
+                settings_save();
+                ssd1306_setMirror(0);
+                ssd1306_setContrast(brightness);
+                resumeMirror();
+                return true;
+            }
+            break;
+
+        case '@':  // I2C address
+            if (count == 1) {  // get I2C address
+                uint8_t address = settings_getI2CAddress(display);
+                OutputBufferAppend(nibbleToHex(address >> 4));  // high nibble
+                OutputBufferAppend(nibbleToHex(address));  // low nibble
+                return true;
+            } else if (count == 3) {  // set I2C address
+                uint8_t address = 0;
+                if (!hexToNibble(*++data, &address)) { return false; }
+                if (!hexToNibble(*++data, &address)) { return false; }
+                settings_setI2CAddress(display, address);
+                settings_save();
+                initSelectedDisplay();
+                return true;
+            }
+            break;
+
+        case '^':  // I2C speed
+            if (count == 1) {  // get I2C speed index
+                uint8_t speedIndex = settings_getI2CSpeedIndex();
+                if (speedIndex == 10) {
+                    OutputBufferAppend('0');
+                } else {
+                    OutputBufferAppend('0' + speedIndex);
+                }
+                return true;
+            } else if (count == 2) {  // set I2C speed index
+                uint8_t speedIndex = *++data;
+                if (speedIndex == '0') {
+                    settings_setI2CSpeedIndex(10);
+                } else if ((speedIndex > '0') && (speedIndex <= '9')) {
+                    settings_setI2CSpeedIndex(speedIndex - '0');
+                } else {
+                    return false;
+                }
+                settings_save();
+                I2CQuietSecondsNeeded = I2C_QUIET_SECONDS_MIN;
+                initOled();
+                return true;
+            }
+            break;
+
+        case '|':  // transport
+            if (count == 1) {  // get if displays are connected over I2C or SPI
+                OutputBufferAppend(settings_getUseSpi() ? 'S' : 'I');
+                return true;
+            } else if (count == 2) {  // set transport
+                switch(*++data) {
+                    case 'I': settings_setUseSpi(false); break;
+                    case 'S': settings_setUseSpi(true); break;
+                    default: return false;
+                }
+                settings_save();
+                initOled();
+                return true;
+            }
+            break;
+
+        case '?':  // statistics
+            if (count == 2) {
+                switch(*++data) {
+                    case 'G': {  // longest time between USB service calls (in microseconds)
+                        uint16_t gap = stats_getUsbGapMax();
+                        gap = (gap < 0x0800) ? (uint16_t)(gap << 5) : 0xFFFF;  // about 32 us per tick
+                        appendHex16(gap);
+                    } return true;
+
+                    case 'S':  // I2C speed currently used (same as setting)
+                        OutputBufferAppend((I2CSpeedIndex == 10) ? '0' : (uint8_t)('0' + I2CSpeedIndex));
+                        return true;
+
+                    case 'E':  // failed I2C writes
+                        appendHex16(stats_getI2CFailCount());
+                        return true;
+
+                    case 'D':  // display restores followed by the partial ones
+                        appendHex16(stats_getRestoreCount());
+                        appendHex16(stats_getPartialRestoreCount());
+                        return true;
+
+                    case 'R':  // reset statistics
+                        stats_reset();
+                        return true;
+                }
+            }
+            break;
+
+        case '&': {  // screen hash
+            uint8_t rowCount = getRowCount();
+            bool isPartial = (rowCount > SCREEN_ROWS);
+            if (isPartial) { rowCount = SCREEN_ROWS; }  // rows below are not recorded
+            if (count == 1) {  // get hash of all rows followed by hash of each row
+                appendHex16(screen_getHash(rowCount));
+                for (uint8_t row = 1; row <= rowCount; row++) {
+                    appendHex16(screen_getRowHash(row));
+                }
+                if (isPartial) { OutputBufferAppend('+'); }
+                return true;
+            } else if (count == 3) {  // get hash of a single row
+                uint8_t row = 0;
+                if (!hexToNibble(*++data, &row)) { return false; }
+                if (!hexToNibble(*++data, &row)) { return false; }
+                if ((row == 0) || (row > rowCount)) { return false; }
+                appendHex16(screen_getRowHash(row));
+                return true;
+            }
+        } break;
+
+        case '`':  // set serial number for USB
+            if (count == 9) {
+                uint8_t* serial = &Settings.UsbSerialValue[8];
+                for (uint8_t i = 0; i < 8; i++) {
+                    *serial = *++data;
+                    serial += 2;
+                }
+                settings_save();
+                reset();
+            }
+            break;
+
+        case '~':  // defaults
+            if (count == 1) {
+                settings_setI2CSpeedIndex(SETTING_DEFAULT_I2C_SPEED_INDEX);
+                settings_setUseSpi(SETTING_DEFAULT_USE_SPI);
+                for (uint8_t i = 0; i < SETTINGS_DISPLAY_COUNT; i++) {
+                    settings_setI2CAddress(i, (i == 0) ? SETTING_DEFAULT_I2C_ADDRESS : SETTING_DEFAULT_I2C_ADDRESS_2);
+                    settings_setDisplayHeight(i, SETTING_DEFAULT_DISPLAY_HEIGHT);
+                    settings_setDisplayBrightness(i, SETTING_DEFAULT_DISPLAY_BRIGHTNESS);
+                    settings_setDisplayInverse(i, SETTING_DEFAULT_DISPLAY_INVERSE);
+                    settings_setDisplayRotate(i, SETTING_DEFAULT_DISPLAY_ROTATE);
+                    settings_setDisplayZoom(i, SETTING_DEFAULT_DISPLAY_ZOOM);
+                }
+                settings_save();
+                return true;
+            }
+            break;
+
+        case 'V':  // Version
+            if (count == 1) {  // get version
+                OutputBufferAppend(0x30 + VERSION_MAJOR);
+                OutputBufferAppend('.');
+                OutputBufferAppend(0x30 + VERSION_MINOR);
+                return true;
+            }
+            break;
+
+    }
+
+    return false;
+}
+
+uint8_t nibbleToHex(const uint8_t value) {
+    uint8_t nibble = value & 0x0F; //just do it on lowest 4 bits
+    if (nibble < 10) {
+        return 0x30 + nibble; //number (0-9)
+    } else {
+        return 0x37 + nibble; //character (A-F)
+    }
+}
+
+void appendHex16(const uint16_t value) {
+    OutputBufferAppend(nibbleToHex((uint8_t)(value >> 12)));
+    OutputBufferAppend(nibbleToHex((uint8_t)(value >> 8)));
+    OutputBufferAppend(nibbleToHex((uint8_t)(value >> 4)));
+    OutputBufferAppend(nibbleToHex((uint8_t)value));
+}
+
+bool hexToNibble(const uint8_t hex, uint8_t* nibble) {
+    *nibble <<= 4;  // move nibble up
+   if ((hex >= 0x30) && (hex <= 0x39)) {
+        *nibble |= hex - 0x30;
+    } else if ((hex >= 0x41) && (hex <= 0x46)) {
+        *nibble |= hex - 0x37;
+    } else if ((hex >= 0x61) && (hex <= 0x66)) {
+        *nibble |= hex - 0x57;
+    } else {
+        return false;
+    }
+    return true;
+}
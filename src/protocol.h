@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/** Initializes display based on settings. */
+void protocol_init(void);
+
+/** Returns true if there is enough input buffer space for the next USB packet. */
+bool protocol_canReceive(void);
+
+/** Returns false from the moment input buffer reaches its high watermark until it drains to the low one; reported to host as DSR. */
+bool protocol_isInputReady(void);
+
+/** Appends received data to input buffer. Returns false if input buffer overflowed. */
+bool protocol_receive(const uint8_t* data, const uint8_t count);
+
+/** Processes complete lines in input buffer and renders queued drawing for about a millisecond. */
+void protocol_process(void);
+
+/** Returns true if all queued drawing is on display. */
+bool protocol_isRendered(void);
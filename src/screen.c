@@ -0,0 +1,327 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "buffer.h"
+#include "screen.h"
+#include "ssd1306.h"
+
+#define SCREEN_RECORD_BLOCKS  ((SCREEN_RECORD_SIZE + BUFFER_BLOCK_SIZE - 1) / BUFFER_BLOCK_SIZE)
+#define SCREEN_CELL_COUNT     (SCREEN_ROWS * SCREEN_COLUMNS)
+
+#define SCREEN_MODE_SMALL  0  // 8x8 character; code 0 is blank
+#define SCREEN_MODE_UPPER  1  // upper half of 8x16 character
+#define SCREEN_MODE_LOWER  2  // lower half of 8x16 character
+#define SCREEN_MODE_GLYPH  3  // custom character; cell holds slot
+
+#if (BUFFER_ARENA_USED / BUFFER_BLOCK_SIZE + SCREEN_RECORD_BLOCKS > BUFFER_ARENA_BLOCKS)
+    #error "Buffer arena is too small for screen record"
+#endif
+
+uint8_t* ScreenCells = NULL;  // character code or glyph slot (starting from 1)
+uint8_t* ScreenModes;         // 2 bits per cell telling what cell holds
+uint8_t* ScreenAttributes;    // 4 bits per cell with attributes cell was drawn with
+uint8_t* ScreenGlyphs;        // 8 bytes per slot
+uint8_t ScreenGlyphNext = 0;  // slot to be replaced next (starting from 0)
+uint8_t ScreenDirtyRows = 0;  // bit per row showing content that is not recorded
+uint8_t ScreenScrollRows = 0; // bit per row scrolled by display controller
+bool ScreenInverse = false;
+
+const uint8_t ScreenBlank[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+
+void screen_init(void) {
+    if (ScreenCells == NULL) {  // arena blocks are lent only once
+        uint8_t* record = buffer_take(SCREEN_RECORD_BLOCKS);
+        if (record == NULL) { return; }  // nothing is recorded
+        ScreenCells = record;
+        ScreenModes = record + SCREEN_CELL_COUNT;
+        ScreenAttributes = ScreenModes + (SCREEN_CELL_COUNT / 4);
+        ScreenGlyphs = ScreenAttributes + (SCREEN_CELL_COUNT / 2);
+    }
+    screen_clear();
+}
+
+void screen_clear(void) {
+    if (ScreenCells == NULL) { return; }
+    for (uint8_t i = 0; i < SCREEN_CELL_COUNT; i++) { ScreenCells[i] = 0; }
+    for (uint8_t i = 0; i < (SCREEN_CELL_COUNT / 4); i++) { ScreenModes[i] = 0; }
+    for (uint8_t i = 0; i < (SCREEN_CELL_COUNT / 2); i++) { ScreenAttributes[i] = 0; }
+    ScreenGlyphNext = 0;
+    ScreenDirtyRows = 0;
+    ScreenScrollRows = 0;
+}
+
+void screen_setInverse(const bool inverse) {
+    ScreenInverse = inverse;
+}
+
+
+bool screen_isRecorded(const uint8_t row, const uint8_t column) {
+    return (ScreenCells != NULL) && (row != 0) && (row <= SCREEN_ROWS) && (column != 0) && (column <= SCREEN_COLUMNS);
+}
+
+uint8_t screen_getMode(const uint8_t index) {
+    return (ScreenModes[index >> 2] >> ((index & 0x03) << 1)) & 0x03;
+}
+
+uint8_t screen_getRowBits(const uint8_t row, const uint8_t rowCount) {  // rows past the record have no bit
+    uint8_t bits = 0;
+    for (uint8_t r = row; (r < row + rowCount) && (r <= SCREEN_ROWS); r++) {
+        if (r != 0) { bits |= (uint8_t)(1 << (r - 1)); }
+    }
+    return bits;
+}
+
+uint8_t screen_getAttributes(const uint8_t index) {
+    return (index & 0x01) ? (ScreenAttributes[index >> 1] >> 4) : (ScreenAttributes[index >> 1] & 0x0F);
+}
+
+bool screen_isBlank(const uint8_t index) {
+    return (ScreenCells[index] == 0) && (screen_getMode(index) == SCREEN_MODE_SMALL) && (screen_getAttributes(index) == 0);
+}
+
+uint8_t screen_getCurrentAttributes(void) {
+    #if defined(_SSD1306_WRITE_ATTRIBUTES)
+        return ssd1306_getAttributes() & 0x0F;
+    #else
+        return 0;
+    #endif
+}
+
+void screen_putCell(const uint8_t row, const uint8_t column, const uint8_t value, const uint8_t mode, const uint8_t attributes) {
+    if (!screen_isRecorded(row, column)) { return; }
+    uint8_t index = (uint8_t)((row - 1) * SCREEN_COLUMNS + (column - 1));
+    ScreenCells[index] = value;
+    uint8_t shift = (uint8_t)((index & 0x03) << 1);
+    ScreenModes[index >> 2] = (uint8_t)((ScreenModes[index >> 2] & ~(0x03 << shift)) | (mode << shift));
+    if (index & 0x01) {
+        ScreenAttributes[index >> 1] = (uint8_t)((ScreenAttributes[index >> 1] & 0x0F) | (attributes << 4));
+    } else {
+        ScreenAttributes[index >> 1] = (uint8_t)((ScreenAttributes[index >> 1] & 0xF0) | attributes);
+    }
+}
+
+uint8_t screen_takeGlyphSlot(const uint8_t* data, const uint8_t keepSlot) {  // returns slot (starting from 1) holding the data; oldest one is replaced
+    uint8_t* glyph = ScreenGlyphs;
+    for (uint8_t slot = 1; slot <= SCREEN_GLYPH_SLOTS; slot++) {  // same glyph is stored only once
+        bool isSame = true;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (glyph[i] != data[i]) { isSame = false; break; }
+        }
+        if (isSame) { return slot; }
+        glyph += 8;
+    }
+
+    uint8_t slot = ScreenGlyphNext + 1;
+    if (slot == keepSlot) { slot = (slot % SCREEN_GLYPH_SLOTS) + 1; }  // other half of the same glyph
+    ScreenGlyphNext = slot % SCREEN_GLYPH_SLOTS;
+
+    for (uint8_t i = 0; i < SCREEN_CELL_COUNT; i++) {  // cells still using the old glyph are forgotten
+        if ((ScreenCells[i] == slot) && (screen_getMode(i) == SCREEN_MODE_GLYPH)) {
+            ScreenDirtyRows |= (uint8_t)(1 << (i / SCREEN_COLUMNS));
+            ScreenCells[i] = 0;
+            ScreenModes[i >> 2] &= (uint8_t)~(0x03 << ((i & 0x03) << 1));
+            ScreenAttributes[i >> 1] &= (i & 0x01) ? 0x0F : 0xF0;
+        }
+    }
+    buffer_copy(&ScreenGlyphs[(uint8_t)((slot - 1) << 3)], data, 8);
+    return slot;
+}
+
+
+void screen_putCharacter(const uint8_t row, const uint8_t column, const uint8_t value, const bool large) {
+    uint8_t attributes = screen_getCurrentAttributes();
+    if (large) {
+        screen_putCell(row, column, value, SCREEN_MODE_UPPER, attributes);
+        screen_putCell(row + 1, column, value, SCREEN_MODE_LOWER, attributes);
+    } else {
+        screen_putCell(row, column, value, SCREEN_MODE_SMALL, attributes);
+    }
+}
+
+void screen_putGlyph(const uint8_t row, const uint8_t column, const uint8_t* data, const bool large) {
+    if (!screen_isRecorded(row, column)) { return; }
+    uint8_t attributes = screen_getCurrentAttributes();
+    uint8_t slot = screen_takeGlyphSlot(data, 0);
+    if (large && screen_isRecorded(row + 1, column)) {
+        screen_putCell(row + 1, column, screen_takeGlyphSlot(data + 8, slot), SCREEN_MODE_GLYPH, attributes);
+    }
+    screen_putCell(row, column, slot, SCREEN_MODE_GLYPH, attributes);
+}
+
+void screen_clearRest(const uint8_t row, const uint8_t column, const bool large) {
+    if (column == 1) { ScreenDirtyRows &= (uint8_t)~screen_getRowBits(row, large ? 2 : 1); }  // whole row matches again
+    for (uint8_t i = column; i <= SCREEN_COLUMNS; i++) {
+        screen_putCell(row, i, 0, SCREEN_MODE_SMALL, 0);
+        if (large) { screen_putCell(row + 1, i, 0, SCREEN_MODE_SMALL, 0); }
+    }
+}
+
+void screen_forgetArea(const uint8_t row, const uint8_t column, const uint8_t rowCount, const uint8_t columnCount) {
+    for (uint8_t r = row; r < row + rowCount; r++) {
+        for (uint8_t c = column; c < column + columnCount; c++) {
+            screen_putCell(r, c, 0, SCREEN_MODE_SMALL, 0);
+        }
+    }
+    screen_forgetRows(row, rowCount);
+}
+
+void screen_forgetRows(const uint8_t row, const uint8_t rowCount) {
+    ScreenDirtyRows |= screen_getRowBits(row, rowCount);
+}
+
+void screen_setScrolling(const uint8_t firstRow, const uint8_t lastRow) {
+    ScreenDirtyRows |= ScreenScrollRows;  // content stays wherever it was moved to
+    ScreenScrollRows = (firstRow == 0) ? 0 : screen_getRowBits(firstRow, (uint8_t)(lastRow - firstRow + 1));
+}
+
+
+void screen_getCell(const uint8_t row, const uint8_t column, uint8_t* data) {
+    const uint8_t* source = &ScreenBlank[0];
+    if (screen_isRecorded(row, column)) {
+        uint8_t index = (uint8_t)((row - 1) * SCREEN_COLUMNS + (column - 1));
+        uint8_t cell = ScreenCells[index];
+        switch (screen_getMode(index)) {
+            case SCREEN_MODE_SMALL:
+                if (cell != 0) { source = ssd1306_getCharacter((char)cell); }
+                break;
+            case SCREEN_MODE_UPPER: source = ssd1306_getCharacter16((char)cell); break;
+            case SCREEN_MODE_LOWER: source = ssd1306_getCharacter16((char)cell) + 8; break;
+            default: source = &ScreenGlyphs[(uint8_t)((cell - 1) << 3)]; break;
+        }
+    }
+    buffer_copy(data, source, 8);
+}
+
+
+bool screen_drawCell(const uint8_t row, const uint8_t column) {  // applies recorded attributes; caller restores current ones
+    #if defined(_SSD1306_WRITE_ATTRIBUTES)
+        ssd1306_setAttributes(0);
+    #endif
+    if (!screen_isRecorded(row, column)) { return ssd1306_drawCustom(&ScreenBlank[0]); }
+    uint8_t index = (uint8_t)((row - 1) * SCREEN_COLUMNS + (column - 1));
+    uint8_t cell = ScreenCells[index];
+    #if defined(_SSD1306_WRITE_ATTRIBUTES)
+        ssd1306_setAttributes(screen_getAttributes(index));
+    #endif
+    switch (screen_getMode(index)) {
+        case SCREEN_MODE_SMALL:
+            if (cell == 0) { return ssd1306_drawCustom(&ScreenBlank[0]); }
+            return ssd1306_writeCharacter((char)cell);
+        case SCREEN_MODE_UPPER: return ssd1306_writeCharacterHalf16((char)cell, false);
+        case SCREEN_MODE_LOWER: return ssd1306_writeCharacterHalf16((char)cell, true);
+        default: return ssd1306_drawCustom(&ScreenGlyphs[(uint8_t)((cell - 1) << 3)]);
+    }
+}
+
+bool screen_isComplete(const uint8_t rowCount, const uint8_t columnCount) {
+    if (rowCount > SCREEN_ROWS) { return false; }  // rows below are not recorded
+    if ((ScreenDirtyRows | ScreenScrollRows) & screen_getRowBits(1, rowCount)) { return false; }
+    if (ScreenCells == NULL) { return true; }
+    uint8_t index = 0;
+    for (uint8_t r = 1; r <= SCREEN_ROWS; r++) {  // content hidden by zoom or left from larger geometry is lost
+        for (uint8_t c = 1; c <= SCREEN_COLUMNS; c++) {
+            if (((r > rowCount) || (c > columnCount)) && !screen_isBlank(index)) { return false; }
+            index++;
+        }
+    }
+    return true;
+}
+
+bool screen_redraw(const uint8_t rowCount, const uint8_t columnCount, const uint8_t row, const uint8_t column) {
+    if (ScreenInverse) {
+        ssd1306_displayInvert();
+    } else {
+        ssd1306_displayNormal();
+    }
+
+    #if defined(_SSD1306_WRITE_ATTRIBUTES)
+        uint8_t attributes = ssd1306_getAttributes();
+    #endif
+    bool ok = true;
+    if (ScreenCells != NULL) {
+        uint8_t index = 0;
+        for (uint8_t r = 1; r <= SCREEN_ROWS; r++) {
+            bool isCursorThere = false;  // blank cells are skipped; display is already clear
+            for (uint8_t c = 1; c <= SCREEN_COLUMNS; c++) {
+                if ((r <= rowCount) && (c <= columnCount) && !screen_isBlank(index)) {
+                    if (!isCursorThere) { ok &= ssd1306_moveTo(r, c); }
+                    ok &= screen_drawCell(r, c);
+                    isCursorThere = true;
+                } else {
+                    isCursorThere = false;
+                }
+                index++;
+            }
+        }
+    }
+
+    if (column > columnCount) {  // cursor past the last column can only be reached by drawing the last cell again
+        ok &= ssd1306_moveTo(row, columnCount);
+        ok &= screen_drawCell(row, columnCount);
+    } else {
+        ok &= ssd1306_moveTo(row, column);
+    }
+    #if defined(_SSD1306_WRITE_ATTRIBUTES)
+        ssd1306_setAttributes(attributes);
+    #endif
+    return ok;
+}
+
+
+uint16_t screen_crc(uint16_t crc, const uint8_t value) {
+    crc ^= (uint16_t)value << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+uint16_t screen_hashRow(uint16_t crc, const uint8_t row) {  // cell is hashed as 00 (blank), code (8x8), 01 code (upper half of 8x16), 02 code (lower half of 8x16), 03 and 8 glyph bytes, or 04 code (8x8 below 0x20); 06 attributes goes first if there are any
+    if ((ScreenDirtyRows | ScreenScrollRows) & screen_getRowBits(row, 1)) { crc = screen_crc(crc, 0x05); }  // host never hashes 05, so row is always redrawn
+    uint8_t index = (uint8_t)((row - 1) * SCREEN_COLUMNS);
+    for (uint8_t c = 0; c < SCREEN_COLUMNS; c++) {
+        uint8_t cell = 0;
+        uint8_t mode = SCREEN_MODE_SMALL;
+        if (ScreenCells != NULL) {
+            cell = ScreenCells[index];
+            mode = screen_getMode(index);
+            uint8_t attributes = screen_getAttributes(index);
+            if (attributes != 0) {
+                crc = screen_crc(crc, 0x06);
+                crc = screen_crc(crc, attributes);
+            }
+        }
+        switch (mode) {
+            case SCREEN_MODE_SMALL:
+                if ((cell != 0) && (cell < 0x20)) { crc = screen_crc(crc, 0x04); }
+                crc = screen_crc(crc, cell);
+                break;
+            case SCREEN_MODE_UPPER:
+            case SCREEN_MODE_LOWER:
+                crc = screen_crc(crc, mode);
+                crc = screen_crc(crc, cell);
+                break;
+            default: {
+                crc = screen_crc(crc, 0x03);
+                uint8_t* glyph = &ScreenGlyphs[(uint8_t)((cell - 1) << 3)];
+                for (uint8_t i = 0; i < 8; i++) { crc = screen_crc(crc, glyph[i]); }
+            } break;
+        }
+        index++;
+    }
+    return crc;
+}
+
+uint16_t screen_getRowHash(const uint8_t row) {
+    if ((row == 0) || (row > SCREEN_ROWS)) { return 0xFFFF; }
+    return screen_hashRow(0xFFFF, row);
+}
+
+uint16_t screen_getHash(const uint8_t rowCount) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t r = 1; (r <= rowCount) && (r <= SCREEN_ROWS); r++) {
+        crc = screen_hashRow(crc, r);
+    }
+    return screen_crc(crc, ScreenInverse ? 0x01 : 0x00);
+}
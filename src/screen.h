@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Screen record - what selected display should show; used to redraw display that came back blank
+#define SCREEN_ROWS         8   // rows below are not recorded
+#define SCREEN_COLUMNS      16
+#define SCREEN_GLYPH_SLOTS  2   // custom characters kept; cells using an older one are forgotten
+#define SCREEN_RECORD_SIZE  (SCREEN_ROWS * SCREEN_COLUMNS + SCREEN_ROWS * SCREEN_COLUMNS / 4 + SCREEN_ROWS * SCREEN_COLUMNS / 2 + SCREEN_GLYPH_SLOTS * 8)  // cells, modes, attributes, glyphs
+
+
+/** Takes record memory from buffer arena and clears the record. */
+void screen_init(void);
+
+/** Forgets all recorded content. */
+void screen_clear(void);
+
+/** Records whether display is inverted. */
+void screen_setInverse(const bool inverse);
+
+/** Records character with current attributes at given row and column (starting from 1). Large character also covers the row below. */
+void screen_putCharacter(const uint8_t row, const uint8_t column, const uint8_t value, const bool large);
+
+/** Records custom character (8 bytes or 16 bytes if large) with current attributes at given row and column (starting from 1). */
+void screen_putGlyph(const uint8_t row, const uint8_t column, const uint8_t* data, const bool large);
+
+/** Records clearing from given row and column (starting from 1) to the end of row. Large clear also covers the row below. */
+void screen_clearRest(const uint8_t row, const uint8_t column, const bool large);
+
+/** Records that given number of rows and columns starting at given row and column (starting from 1) show content that is not recorded. Cells are left blank and their rows no longer match the record. */
+void screen_forgetArea(const uint8_t row, const uint8_t column, const uint8_t rowCount, const uint8_t columnCount);
+
+/** Records that given number of rows starting at given row (starting from 1) no longer match the record until they are cleared. */
+void screen_forgetRows(const uint8_t row, const uint8_t rowCount);
+
+/** Records rows (starting from 1) that display controller keeps scrolling; 0 if it stopped. Rows that were scrolling no longer match the record. */
+void screen_setScrolling(const uint8_t firstRow, const uint8_t lastRow);
+
+/** Fills 8 bytes with recorded content of given row and column (starting from 1) without attributes; blank if nothing is recorded. */
+void screen_getCell(const uint8_t row, const uint8_t column, uint8_t* data);
+
+/** Returns true if record holds all content shown in given row and column count and there is no recorded content outside of them. */
+bool screen_isComplete(const uint8_t rowCount, const uint8_t columnCount);
+
+/** Draws recorded content with its attributes on selected display of given row and column count and leaves cursor at given position (column can be one past the last). */
+bool screen_redraw(const uint8_t rowCount, const uint8_t columnCount, const uint8_t row, const uint8_t column);
+
+
+/** Returns CRC-16 (CCITT, initial value 0xFFFF) of recorded content in given row (starting from 1). Row that doesn't match the record is hashed with 05 first. */
+uint16_t screen_getRowHash(const uint8_t row);
+
+/** Returns CRC-16 (CCITT, initial value 0xFFFF) of recorded content in the first rowCount rows followed by inversion. */
+uint16_t screen_getHash(const uint8_t rowCount);
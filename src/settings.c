@@ -2,7 +2,6 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "settings.h"
-#include "Microchip/usb_device.h"
 
 
 void settings_init(void) {
@@ -22,17 +21,20 @@ void settings_save(void) {
     uint8_t* settingsPtr = (uint8_t*)&Settings;
 
     // erase
-    PMADR = address;         // set location
-    PMCON1bits.CFGS = 0;     // program space
-    PMCON1bits.FREE = 1;     // erase
-    PMCON2 = 0x55;           // unlock
-    PMCON2 = 0xAA;           // unlock
-    PMCON1bits.WR = 1;       // begin erase
-    asm("NOP"); asm("NOP");  // forced
+    for (uint8_t i = 0; i < _SETTINGS_FLASH_SIZE; i += 32) {
+        PMADR = address + i;     // set location
+        PMCON1bits.CFGS = 0;     // program space
+        PMCON1bits.FREE = 1;     // erase
+        PMCON2 = 0x55;           // unlock
+        PMCON2 = 0xAA;           // unlock
+        PMCON1bits.WR = 1;       // begin erase
+        asm("NOP"); asm("NOP");  // forced
+    }
 
     // write
     for (uint8_t i = 1; i <= sizeof(Settings); i++) {
-        unsigned latched = (i == sizeof(Settings)) ? 0 : 1;  // latch load is done for all except last
+        bool isRowEnd = ((address & 0x1F) == 0x1F);  // latches are written at the end of each erase block
+        unsigned latched = ((i == sizeof(Settings)) || isRowEnd) ? 0 : 1;  // latch load is done for all except last
         PMADR = address;            // set location
         PMDATH = 0x3F;              // same as when erased
         PMDATL = *settingsPtr;      // load data
@@ -51,13 +53,14 @@ void settings_save(void) {
 }
 
 
-uint8_t settings_getI2CAddress(void) {
-    uint8_t value = Settings.I2CAddress;
-    return (value > 0) ? value : SETTING_DEFAULT_I2C_ADDRESS;
+uint8_t settings_getI2CAddress(const uint8_t display) {
+    uint8_t value = Settings.Displays[display].I2CAddress;
+    if (value > 0) { return value; }
+    return (display == 0) ? SETTING_DEFAULT_I2C_ADDRESS : SETTING_DEFAULT_I2C_ADDRESS_2;
 }
 
-void settings_setI2CAddress(const uint8_t value) {
-    Settings.I2CAddress = value;
+void settings_setI2CAddress(const uint8_t display, const uint8_t value) {
+    Settings.Displays[display].I2CAddress = value;
 }
 
 
@@ -72,43 +75,71 @@ void settings_setI2CSpeedIndex(const uint8_t value) {
 }
 
 
-uint8_t settings_getDisplayHeight(void) {
-    if (Settings.DisplayHeight == 32) {
+bool settings_getUseSpi(void) {
+    return (Settings.UseSpi == 1);  // anything else (e.g. erased) is I2C
+}
+
+void settings_setUseSpi(const bool value) {
+    Settings.UseSpi = value ? 1 : 0;
+}
+
+
+uint8_t settings_getDisplayHeight(const uint8_t display) {
+    uint8_t value = Settings.Displays[display].DisplayHeight;
+    if (value == 32) {
         return 32;
-    } else if (Settings.DisplayHeight == 128) {
+    } else if (value == 128) {
         return 128;
     } else {
         return 64;
     }
 }
 
-void settings_setDisplayHeight(const uint8_t value) {
-    Settings.DisplayHeight = value;
+void settings_setDisplayHeight(const uint8_t display, const uint8_t value) {
+    Settings.Displays[display].DisplayHeight = value;
+}
+
+
+uint8_t settings_getDisplayBrightness(const uint8_t display) {
+    return Settings.Displays[display].DisplayBrightness;
+}
+
+void settings_setDisplayBrightness(const uint8_t display, const uint8_t value) {
+    Settings.Displays[display].DisplayBrightness = value;
+}
+
+
+bool settings_getDisplayInverse(const uint8_t display) {
+    return (Settings.Displays[display].DisplayInverse != 0);
+}
+
+void settings_setDisplayInverse(const uint8_t display, const bool value) {
+    Settings.Displays[display].DisplayInverse = value ? 1 : 0;
 }
 
 
-uint8_t settings_getDisplayBrightness(void) {
-    return Settings.DisplayBrightness;
+bool settings_getDisplayFlip(const uint8_t display) {
+    return (Settings.Displays[display].DisplayFlip != 0);
 }
 
-void settings_setDisplayBrightness(const uint8_t value) {
-    Settings.DisplayBrightness = value;
+void settings_setDisplayFlip(const uint8_t display, const bool value) {
+    Settings.Displays[display].DisplayFlip = value ? 1 : 0;
 }
 
 
-bool settings_getDisplayInverse(void) {
-    return (Settings.DisplayInverse != 0);
+bool settings_getDisplayRotate(const uint8_t display) {
+    return (Settings.Displays[display].DisplayRotate != 0);
 }
 
-void settings_setDisplayInverse(const bool value) {
-    Settings.DisplayInverse = value ? 1 : 0;
+void settings_setDisplayRotate(const uint8_t display, const bool value) {
+    Settings.Displays[display].DisplayRotate = value ? 1 : 0;
 }
 
 
-bool settings_getDisplayFlip(void) {
-    return (Settings.DisplayFlip != 0);
+bool settings_getDisplayZoom(const uint8_t display) {
+    return (Settings.Displays[display].DisplayZoom != 0);
 }
 
-void settings_setDisplayFlip(const bool value) {
-    Settings.DisplayFlip = value ? 1 : 0;
+void settings_setDisplayZoom(const uint8_t display, const bool value) {
+    Settings.Displays[display].DisplayZoom = value ? 1 : 0;
 }
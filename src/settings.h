@@ -1,37 +1,61 @@
 #pragma once
 
+#define SETTINGS_DISPLAY_COUNT              2
+
 #define SETTING_DEFAULT_I2C_ADDRESS         0x3C
+#define SETTING_DEFAULT_I2C_ADDRESS_2       0x3D
 #define SETTING_DEFAULT_I2C_SPEED_INDEX     1
 #define SETTING_DEFAULT_DISPLAY_HEIGHT      64
 #define SETTING_DEFAULT_DISPLAY_BRIGHTNESS  0xCF
 #define SETTING_DEFAULT_DISPLAY_INVERSE     0
 #define SETTING_DEFAULT_DISPLAY_FLIP        0
+#define SETTING_DEFAULT_DISPLAY_ROTATE      0
+#define SETTING_DEFAULT_DISPLAY_ZOOM        0
+#define SETTING_DEFAULT_USE_SPI             0
 
 #define _SETTINGS_FLASH_RAW {                                                                \
-                              SETTING_DEFAULT_I2C_ADDRESS,                                   \
                               SETTING_DEFAULT_I2C_SPEED_INDEX,                               \
+                              26, 0x03,                                                      \
+                              'E', 0, 'A', 0, '9', 0, 'E', 0,                                \
+                              '1', 0, '9', 0, '7', 0, '9', 0,                                \
+                              '2', 0, '8', 0, '0', 0, '1', 0,                                \
+                              SETTING_DEFAULT_I2C_ADDRESS,                                   \
                               SETTING_DEFAULT_DISPLAY_HEIGHT,                                \
                               SETTING_DEFAULT_DISPLAY_BRIGHTNESS,                            \
                               SETTING_DEFAULT_DISPLAY_INVERSE,                               \
                               SETTING_DEFAULT_DISPLAY_FLIP,                                  \
-                              26, 0x03,                                                      \
-                              'E', 0, 'A', 0, '9', 0, 'E', 0,                                \
-                              '1', 0, '9', 0, '7', 0, '9', 0,                                \
-                              '2', 0, '8', 0, '0', 0, '1', 0                                 \
-                            }  // reserving space because erase block is block 32-word (32-bytes as only low bytes are used)
-#define _SETTINGS_FLASH_LOCATION 0x1FE0
-const uint8_t _SETTINGS_PROGRAM[] __at(_SETTINGS_FLASH_LOCATION) = _SETTINGS_FLASH_RAW;
+                              SETTING_DEFAULT_DISPLAY_ROTATE,                                \
+                              SETTING_DEFAULT_DISPLAY_ZOOM,                                  \
+                              SETTING_DEFAULT_I2C_ADDRESS_2,                                 \
+                              SETTING_DEFAULT_DISPLAY_HEIGHT,                                \
+                              SETTING_DEFAULT_DISPLAY_BRIGHTNESS,                            \
+                              SETTING_DEFAULT_DISPLAY_INVERSE,                               \
+                              SETTING_DEFAULT_DISPLAY_FLIP,                                  \
+                              SETTING_DEFAULT_DISPLAY_ROTATE,                                \
+                              SETTING_DEFAULT_DISPLAY_ZOOM,                                  \
+                              SETTING_DEFAULT_USE_SPI                                        \
+                            }  // reserving space because erase block is block 32-word (32-bytes as only low bytes are used); displays need two blocks
+#define _SETTINGS_FLASH_LOCATION 0x1FC0
+#define _SETTINGS_FLASH_SIZE     64  // two erase blocks
+const uint8_t _SETTINGS_PROGRAM[_SETTINGS_FLASH_SIZE] __at(_SETTINGS_FLASH_LOCATION) = _SETTINGS_FLASH_RAW;
 
 typedef struct {
     uint8_t I2CAddress;
-    uint8_t I2CSpeedIndex;
     uint8_t DisplayHeight;
     uint8_t DisplayBrightness;
     uint8_t DisplayInverse;
     uint8_t DisplayFlip;
+    uint8_t DisplayRotate;
+    uint8_t DisplayZoom;
+} SettingsDisplayRecord;
+
+typedef struct {
+    uint8_t I2CSpeedIndex;
     uint8_t UsbSerialLength;
     uint8_t UsbSerialType;
     uint8_t UsbSerialValue[24];
+    SettingsDisplayRecord Displays[SETTINGS_DISPLAY_COUNT];
+    uint8_t UseSpi;
 } SettingsRecord;
 
 SettingsRecord Settings;
@@ -44,11 +68,11 @@ void settings_init(void);
 void settings_save(void);
 
 
-/** Gets OLED's I2C address. */
-uint8_t settings_getI2CAddress(void);
+/** Gets OLED's I2C address. Each display has its own settings, index starting from 0. */
+uint8_t settings_getI2CAddress(const uint8_t display);
 
 /** Sets OLED's I2C address. */
-void settings_setI2CAddress(const uint8_t value);
+void settings_setI2CAddress(const uint8_t display, const uint8_t value);
 
 
 /** Gets OLED's I2C speed (in 100kHz). */
@@ -58,29 +82,50 @@ uint8_t settings_getI2CSpeedIndex(void);
 void settings_setI2CSpeedIndex(const uint8_t value);
 
 
+/** Gets if displays are connected over SPI instead of I2C. */
+bool settings_getUseSpi(void);
+
+/** Sets if displays are connected over SPI instead of I2C. */
+void settings_setUseSpi(const bool value);
+
+
 /** Gets screen height. Only 64 (A-type) and 32 (B-type) are supported. */
-uint8_t settings_getDisplayHeight(void);
+uint8_t settings_getDisplayHeight(const uint8_t display);
 
 /** Sets screen height. */
-void settings_setDisplayHeight(const uint8_t value);
+void settings_setDisplayHeight(const uint8_t display, const uint8_t value);
 
 
 /** Gets OLED's brightness. */
-uint8_t settings_getDisplayBrightness(void);
+uint8_t settings_getDisplayBrightness(const uint8_t display);
 
 /** Sets OLED's brightness. */
-void settings_setDisplayBrightness(const uint8_t value);
+void settings_setDisplayBrightness(const uint8_t display, const uint8_t value);
 
 
 /** Gets if OLED's display is inverted. */
-bool settings_getDisplayInverse(void);
+bool settings_getDisplayInverse(const uint8_t display);
 
 /** Sets if OLED's display is inverted. */
-void settings_setDisplayInverse(const bool value);
+void settings_setDisplayInverse(const uint8_t display, const bool value);
 
 
 /** Gets if OLED's display is flipped. */
-bool settings_getDisplayFlip(void);
+bool settings_getDisplayFlip(const uint8_t display);
 
 /** Sets if OLED's display is flipped. */
-void settings_setDisplayFlip(const bool value);
+void settings_setDisplayFlip(const uint8_t display, const bool value);
+
+
+/** Gets if OLED's display is rotated by 90 degrees (270 degrees if also flipped). */
+bool settings_getDisplayRotate(const uint8_t display);
+
+/** Sets if OLED's display is rotated by 90 degrees. */
+void settings_setDisplayRotate(const uint8_t display, const bool value);
+
+
+/** Gets if OLED's display is zoomed to double height. */
+bool settings_getDisplayZoom(const uint8_t display);
+
+/** Sets if OLED's display is zoomed to double height. */
+void settings_setDisplayZoom(const uint8_t display, const bool value);
@@ -0,0 +1,64 @@
+/* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+
+#include <xc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app.h"
+#include "io.h"
+#include "spi_master.h"
+
+#if defined(_SPI_MASTER_TIMEOUT_TICKS)
+    #include "system.h"  // getTicks
+    #define spi_master_16f_timerStart()                getTicks()
+    #define spi_master_16f_timerExpired(startTicks)    ((uint16_t)(getTicks() - (startTicks)) >= _SPI_MASTER_TIMEOUT_TICKS)
+#else
+    #define spi_master_16f_timerStart()                0
+    #define spi_master_16f_timerExpired(startTicks)    false
+#endif
+
+
+void spi_master_init(const uint8_t rate) {
+    SSPCON1 = 0;  SSPCON2 = 0;  SSPSTAT = 0;  // reset all
+
+    uint8_t divider = (uint8_t)((_XTAL_FREQ / 4 / 1000000 + rate - 1) / rate);  // rounded up so clock is never faster
+    if (divider == 0) { divider = 1; }
+    SSP1ADD = divider - 1;                    // clock is FOSC / (4 * (SSP1ADD + 1))
+    SSPSTATbits.CKE = 1;                      // data changes on falling edge; sampled on rising (mode 0)
+    SSPCON1bits.CKP = 0;                      // clock is idle low
+    SSPCON1bits.SSPM = 0b1010;                // SPI master mode with SSP1ADD clock
+    SSPCON1bits.SSPEN = 1;                    // enable SPI master mode
+
+    TRISC0 = 0;                               // clock pin configured as output
+    TRISC2 = 0;                               // data pin configured as output
+    io_spi_init();                            // data/command and chip selects
+}
+
+
+bool spi_master_16f_writeByte(const uint8_t value) {
+    SSPBUF = value;                                       // set data
+    if (SSPCON1bits.WCOL) {                               // fail if there is a collision
+        SSPCON1bits.WCOL = 0;
+        return false;
+    }
+    uint16_t startTicks = spi_master_16f_timerStart();
+    while (!SSPSTATbits.BF) {                             // wait until byte is shifted out
+        if (spi_master_16f_timerExpired(startTicks)) { return false; }
+    }
+    (void)SSPBUF;                                         // clears BF; nothing is received
+    return true;
+}
+
+bool spi_master_writeBytes(const uint8_t device, const bool isData, const uint8_t* data, const uint8_t count) {  // data of NULL writes zeros
+    if (isData) { io_spi_data(); } else { io_spi_command(); }
+    io_spi_select(device);
+
+    bool ok = true;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!spi_master_16f_writeByte((data != NULL) ? *data : 0)) { ok = false; break; }
+        if (data != NULL) { data++; }
+    }
+
+    io_spi_deselect();
+    return ok;
+}
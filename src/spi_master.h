@@ -0,0 +1,27 @@
+/* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+// 2024-11-10: Initial version
+
+/**
+ * Handling SPI master communication (write only, mode 0)
+ *
+ * Defines used:
+ *   _SPI_MASTER_TIMEOUT_TICKS <N>: If used, limits each wait to N getTicks() ticks
+ *
+ * Notes:
+ *   Clock is on RC0 and data is on RC2; both are configured as output
+ *   Chip select and data/command pins are handled in io.h
+ *   Lowest bit of device selects chip select line
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app.h"
+
+
+/** Initializes SPI as a master; rate is in MHz and clock never goes above it. */
+void spi_master_init(const uint8_t rate);
+
+/** Writes multiple bytes with data/command pin set as given. Data of NULL writes zeros. */
+bool spi_master_writeBytes(const uint8_t device, const bool isData, const uint8_t* data, const uint8_t count);
@@ -1,17 +1,27 @@
 /* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
 
 #include <xc.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "app.h"
 #include "ssd1306.h"
 #include "ssd1306_font.h"
 #include "i2c_master.h"
+#if defined(_SSD1306_TRANSPORT_SPI)
+    #include "spi_master.h"
+#endif
 
 #define SSD1306_SET_LOWER_START_COLUMN_ADDRESS       0x00
 #define SSD1306_SET_UPPER_START_COLUMN_ADDRESS       0x10
 #define SSD1306_SET_MEMORY_ADDRESSING_MODE           0x20
 #define SSD1306_SET_COLUMN_ADDRESS                   0x21
 #define SSD1306_SET_PAGE_ADDRESS                     0x22
+#define SSD1306_RIGHT_HORIZONTAL_SCROLL              0x26
+#define SSD1306_LEFT_HORIZONTAL_SCROLL               0x27
+#define SSD1306_CONTENT_SCROLL_RIGHT                 0x2C
+#define SSD1306_CONTENT_SCROLL_LEFT                  0x2D
+#define SSD1306_DEACTIVATE_SCROLL                    0x2E
+#define SSD1306_ACTIVATE_SCROLL                      0x2F
 #define SSD1306_SET_DISPLAY_START_LINE               0x40
 #define SSD1306_SET_CONTRAST_CONTROL                 0x81
 #define SSD1306_SET_CHARGE_PUMP                      0x8D
@@ -30,13 +40,25 @@
 #define SSD1306_SET_DISPLAY_OFFSET                   0xD3
 #define SSD1306_SET_DISPLAY_CLOCK_DIVIDE_RATIO       0xD5
 #define SSD1306_SET_PRECHARGE_PERIOD                 0xD9
+#define SSD1306_SET_ZOOM_IN                          0xD6
 #define SSD1306_SET_COM_PINS_HARDWARE_CONFIGURATION  0xDA
 #define SSD1306_SET_VCOMH_DESELECT_LEVEL             0xDB
+#define SSD1306_NOP                                  0xE3
+
+#define SSD1306_UNDERLINE_MASK  0x80  // bottom pixel row
+#define SSD1306_STRIKE_MASK_8   0x08  // same row as 8x8 dash
+#define SSD1306_STRIKE_MASK_16  0x80  // same row as 8x16 dash (upper half)
 
-void ssd1306_writeRawCommand1(const uint8_t datum1);
-void ssd1306_writeRawCommand2(const uint8_t datum1, const uint8_t datum2);
-void ssd1306_writeRawData(const uint8_t* data, const uint8_t count);
-void ssd1306_writeRawDataZeros(const uint8_t count);
+#define SSD1306_MIRROR_ERROR_MAX  8  // consecutive failed writes before mirror is dropped
+
+bool ssd1306_writeTransport(const uint8_t address, const uint8_t control, const uint8_t* data, const uint8_t count);
+bool ssd1306_writeRawCommand1(const uint8_t datum1);
+bool ssd1306_writeRawCommand2(const uint8_t datum1, const uint8_t datum2);
+bool ssd1306_writeRawCommands(const uint8_t* data, const uint8_t count);
+bool ssd1306_writeRawData(const uint8_t* data, const uint8_t count);
+bool ssd1306_writeRawDataZeros(const uint8_t count);
+bool ssd1306_writeAddress(const uint8_t row, const uint8_t column);
+bool ssd1306_writeCellData(const uint8_t* data, const uint8_t underlineMask, const uint8_t strikeMask);
 
 
 #if defined(_SSD1306_CUSTOM_INIT)
@@ -55,9 +77,57 @@ void ssd1306_writeRawDataZeros(const uint8_t count);
 
 uint8_t currentRow;
 uint8_t currentColumn;
+#if defined(_SSD1306_FONT_8x8) && defined(_SSD1306_WRITE_PROPORTIONAL)
+    uint8_t currentPixel;  // valid only while current column is the first whole column after it
+#endif
+
+uint8_t writeErrorCount;
+
+#if defined(_SSD1306_WRITE_ATTRIBUTES)
+    uint8_t currentAttributes = 0;
+#endif
+
+#if defined(_SSD1306_CONTROL_ROTATE)
+    bool displayRotated = false;  // rows run along display width; written in horizontal addressing mode
+#endif
+
+#if defined(_SSD1306_CONTROL_ZOOM)
+    bool displayZoomed = false;  // each pixel row is shown twice; only the upper half of pages is visible
+#endif
+
+#if defined(_SSD1306_TRANSPORT_SPI)
+    uint8_t displayTransport = SSD1306_TRANSPORT_I2C;
+#endif
+
+#if (_SSD1306_DISPLAY_COUNT > 1)
+    typedef struct {
+        uint8_t Address;
+        uint8_t Width;
+        uint8_t Height;
+        uint8_t Row;
+        uint8_t Column;
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            bool Rotated;
+        #endif
+        #if defined(_SSD1306_CONTROL_ZOOM)
+            bool Zoomed;
+        #endif
+        uint8_t MirrorErrors;  // consecutive failed writes while mirrored
+    } DisplayContext;
+
+    DisplayContext displayContexts[_SSD1306_DISPLAY_COUNT];  // selected display lives in globals above; this is only a copy
+    uint8_t displayIndex;
+    uint8_t displayMirror;  // displays getting the same writes; never includes selected one
+    uint8_t displayMirrorLost;  // displays dropped from mirroring since last taken
+
+    void ssd1306_syncMirrors(void);
+#endif
 
 void ssd1306_internalInit() {
     ssd1306_writeRawCommand1(SSD1306_SET_DISPLAY_OFF);                                    // Set Display Off
+    #if defined(_SSD1306_CONTROL_SCROLL)
+        ssd1306_writeRawCommand1(SSD1306_DEACTIVATE_SCROLL);                              // Deactivate Scroll (survives reset of everything else)
+    #endif
     ssd1306_writeRawCommand2(SSD1306_SET_DISPLAY_CLOCK_DIVIDE_RATIO, 0xF0);               // Set Display Clock Divide Ratio/Oscillator Frequency (highest frequency)
     ssd1306_writeRawCommand2(SSD1306_SET_MULTIPLEX_RATIO, displayHeight - 1);             // Set Multiplex Ratio (line count - 1)
     ssd1306_writeRawCommand2(SSD1306_SET_DISPLAY_OFFSET, 0x00);                           // Set Display Offset
@@ -84,6 +154,9 @@ void ssd1306_internalInit() {
     ssd1306_writeRawCommand1(SSD1306_SET_NORMAL_DISPLAY);                                 // Set Normal Display
 
     ssd1306_writeRawCommand2(SSD1306_SET_MEMORY_ADDRESSING_MODE, 0b10);                   // Set Page addressing mode
+    #if defined(_SSD1306_CONTROL_ZOOM)
+        ssd1306_writeRawCommand2(SSD1306_SET_ZOOM_IN, 0x00);                              // Set Zoom In (disabled)
+    #endif
 
     ssd1306_clearAll();
 
@@ -97,6 +170,12 @@ void ssd1306_internalInit() {
         displayHeight = height;
         displayColumns = width / 8;
         displayRows = height / 8;
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            displayRotated = false;
+        #endif
+        #if defined(_SSD1306_CONTROL_ZOOM)
+            displayZoomed = false;
+        #endif
         ssd1306_internalInit();
     }
 #else
@@ -105,6 +184,111 @@ void ssd1306_internalInit() {
     }
 #endif
 
+#if defined(_SSD1306_CUSTOM_INIT)
+    bool ssd1306_probe(const uint8_t address) {
+        uint8_t command = SSD1306_NOP;
+        return ssd1306_writeTransport(address, 0x00, &command, 1);
+    }
+#endif
+
+
+#if defined(_SSD1306_TRANSPORT_SPI)
+    void ssd1306_setTransport(const uint8_t transport) {
+        displayTransport = transport;
+    }
+#endif
+
+
+uint8_t ssd1306_takeErrorCount(void) {
+    uint8_t count = writeErrorCount;
+    writeErrorCount = 0;
+    return count;
+}
+
+
+#if (_SSD1306_DISPLAY_COUNT > 1)
+    void ssd1306_selectDisplay(const uint8_t index) {
+        displayMirror = 0;
+        if ((index == displayIndex) || (index >= _SSD1306_DISPLAY_COUNT)) { return; }
+
+        DisplayContext* context = &displayContexts[displayIndex];
+        context->Address = displayAddress;
+        context->Width = displayWidth;
+        context->Height = displayHeight;
+        context->Row = currentRow;
+        context->Column = currentColumn;
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            context->Rotated = displayRotated;
+        #endif
+        #if defined(_SSD1306_CONTROL_ZOOM)
+            context->Zoomed = displayZoomed;
+        #endif
+
+        context = &displayContexts[index];
+        displayIndex = index;
+        displayAddress = context->Address;
+        displayWidth = context->Width;
+        displayHeight = context->Height;
+        displayColumns = context->Width / 8;
+        displayRows = context->Height / 8;
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            displayRotated = context->Rotated;
+            if (displayRotated) {
+                displayColumns = context->Height / 8;
+                displayRows = context->Width / 8;
+            }
+        #endif
+        #if defined(_SSD1306_CONTROL_ZOOM)
+            displayZoomed = context->Zoomed;
+            if (displayZoomed) { displayRows = context->Height / 16; }
+        #endif
+        if (displayAddress != 0) {  // mirrored writes might have moved hardware cursor
+            ssd1306_moveTo(context->Row + 1, context->Column + 1);
+        }
+    }
+
+    uint8_t ssd1306_getDisplay(void) {
+        return displayIndex;
+    }
+
+    bool ssd1306_setMirror(const uint8_t mask) {  // mirrors get raw bytes, so they must lay them out the same way
+        displayMirror = 0;
+        uint8_t newMirror = mask & (uint8_t)~(1 << displayIndex);
+        for (uint8_t i = 0; i < _SSD1306_DISPLAY_COUNT; i++) {
+            if ((newMirror & (1 << i)) == 0) { continue; }
+            DisplayContext* context = &displayContexts[i];
+            if ((context->Width != displayWidth) || (context->Height != displayHeight)) { return false; }
+            #if defined(_SSD1306_CONTROL_ROTATE)
+                if (context->Rotated != displayRotated) { return false; }
+            #endif
+            #if defined(_SSD1306_CONTROL_ZOOM)
+                if (context->Zoomed != displayZoomed) { return false; }
+            #endif
+            context->MirrorErrors = 0;
+        }
+        displayMirror = newMirror;
+        return true;
+    }
+
+    void ssd1306_syncMirrors(void) {  // mirrors got the same geometry commands
+        for (uint8_t i = 0; i < _SSD1306_DISPLAY_COUNT; i++) {
+            if ((displayMirror & (1 << i)) == 0) { continue; }
+            #if defined(_SSD1306_CONTROL_ROTATE)
+                displayContexts[i].Rotated = displayRotated;
+            #endif
+            #if defined(_SSD1306_CONTROL_ZOOM)
+                displayContexts[i].Zoomed = displayZoomed;
+            #endif
+        }
+    }
+
+    uint8_t ssd1306_takeMirrorLost(void) {
+        uint8_t lost = displayMirrorLost;
+        displayMirrorLost = 0;
+        return lost;
+    }
+#endif
+
 
 #if defined(_SSD1306_CONTROL_DISPLAY)
     void ssd1306_displayOff(void) {
@@ -128,16 +312,134 @@ void ssd1306_internalInit() {
 
 #if defined(_SSD1306_CONTROL_FLIP)
     void ssd1306_displayFlip(bool flipped) {
+        bool comReversed = flipped;
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { comReversed = !flipped; }  // mirroring one axis turns transposed content into rotated one
+        #endif
         if (flipped) {
             ssd1306_writeRawCommand1(SSD1306_SET_SEGMENT_REMAP_COL127);                       // Set Segment Re-Map
-            ssd1306_writeRawCommand1(SSD1306_SET_COM_OUTPUT_SCAN_DIRECTION_DEC);              // Set COM Output Scan Direction
         } else {
             ssd1306_writeRawCommand1(SSD1306_SET_SEGMENT_REMAP_COL0);                         // Set Segment Re-Map
+        }
+        if (comReversed) {
+            ssd1306_writeRawCommand1(SSD1306_SET_COM_OUTPUT_SCAN_DIRECTION_DEC);              // Set COM Output Scan Direction
+        } else {
             ssd1306_writeRawCommand1(SSD1306_SET_COM_OUTPUT_SCAN_DIRECTION_INC);              // Set COM Output Scan Direction
         }
     }
 #endif
 
+#if defined(_SSD1306_CONTROL_ROTATE)
+    void ssd1306_displayRotate(const bool rotated) {
+        displayRotated = rotated;
+        if (rotated) {
+            displayColumns = displayHeight / 8;
+            displayRows = displayWidth / 8;
+        } else {
+            displayColumns = displayWidth / 8;
+            displayRows = displayHeight / 8;
+        }
+        ssd1306_writeRawCommand2(SSD1306_SET_MEMORY_ADDRESSING_MODE, rotated ? 0b00 : 0b10);  // horizontal addressing moves rotated characters down pages
+        #if (_SSD1306_DISPLAY_COUNT > 1)
+            ssd1306_syncMirrors();
+        #endif
+        ssd1306_moveTo(1, 1);
+    }
+
+    void ssd1306_transpose(uint8_t* data) {  // in place; swaps 4x4 blocks, then 2x2 blocks, then single bits
+        for (uint8_t i = 0; i < 4; i++) {
+            uint8_t t = ((data[i] >> 4) ^ data[i + 4]) & 0x0F;
+            data[i] ^= (uint8_t)(t << 4);
+            data[i + 4] ^= t;
+        }
+        for (uint8_t i = 0; i < 8; i += 4) {
+            for (uint8_t j = i; j < i + 2; j++) {
+                uint8_t t = ((data[j] >> 2) ^ data[j + 2]) & 0x33;
+                data[j] ^= (uint8_t)(t << 2);
+                data[j + 2] ^= t;
+            }
+        }
+        for (uint8_t i = 0; i < 8; i += 2) {
+            uint8_t t = ((data[i] >> 1) ^ data[i + 1]) & 0x55;
+            data[i] ^= (uint8_t)(t << 1);
+            data[i + 1] ^= t;
+        }
+    }
+#endif
+
+#if defined(_SSD1306_CONTROL_ZOOM)
+    bool ssd1306_displayZoom(const bool zoomed) {
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return !zoomed; }  // never zoomed since rows would be stretched sideways
+        #endif
+        if (zoomed && (displayHeight != 64)) { return false; }  // needs alternative COM pins configuration
+        displayZoomed = zoomed;
+        displayRows = zoomed ? displayHeight / 16 : displayHeight / 8;
+        bool ok = ssd1306_writeRawCommand2(SSD1306_SET_ZOOM_IN, zoomed ? 0x01 : 0x00);
+        #if (_SSD1306_DISPLAY_COUNT > 1)
+            ssd1306_syncMirrors();
+        #endif
+        ok &= ssd1306_moveTo(1, 1);
+        return ok;
+    }
+
+    bool ssd1306_isZoomed(void) {
+        return displayZoomed;
+    }
+#endif
+
+#if defined(_SSD1306_CONTROL_SCROLL)
+    bool ssd1306_scrollStart(const uint8_t firstRow, const uint8_t lastRow, const uint8_t speed, const bool left) {
+        static const uint8_t intervals[8] = { 0b011, 0b010, 0b001, 0b110, 0b000, 0b101, 0b100, 0b111 };  // 256, 128, 64, 25, 5, 4, 3, and 2 frames
+        if ((firstRow == 0) || (firstRow > lastRow) || (lastRow > displayRows) || (lastRow > 8) || (speed > 7)) { return false; }  // page is only 3 bits
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }
+        #endif
+        uint8_t setup[7] = {
+            left ? SSD1306_LEFT_HORIZONTAL_SCROLL : SSD1306_RIGHT_HORIZONTAL_SCROLL,
+            0x00, firstRow - 1, intervals[speed], lastRow - 1, 0x00, 0xFF
+        };
+        bool ok = ssd1306_writeRawCommand1(SSD1306_DEACTIVATE_SCROLL);  // setup is ignored while scrolling
+        ok &= ssd1306_writeRawCommands(setup, 7);
+        ok &= ssd1306_writeRawCommand1(SSD1306_ACTIVATE_SCROLL);
+        return ok;
+    }
+
+    bool ssd1306_scrollStop(void) {
+        return ssd1306_writeRawCommand1(SSD1306_DEACTIVATE_SCROLL);
+    }
+
+    bool ssd1306_writeRowPixels(const uint8_t row, const uint8_t x, const uint8_t* data, const uint8_t count) {
+        if ((row == 0) || (row > displayRows) || (row > 8)) { return false; }  // page is only 3 bits
+        if ((count == 0) || ((uint16_t)x + count > displayWidth)) { return false; }
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }
+        #endif
+        bool ok = ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (row - 1));
+        ok &= ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | (x & 0x0F));
+        ok &= ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | (x >> 4));
+        ok &= ssd1306_writeRawData(data, count);
+        uint8_t column = (currentColumn < displayColumns) ? currentColumn : displayColumns - 1;  // past the last column only proportional text writes and it sets its own column
+        ok &= ssd1306_writeAddress(currentRow, column);  // cursor stays where it was
+        return ok;
+    }
+#endif
+
+#if defined(_SSD1306_CONTROL_SCROLL) && defined(_SSD1306_CONTROL_CONTENT_SCROLL)
+    bool ssd1306_scrollRowLeft(const uint8_t row, const uint8_t data) {
+        if ((row == 0) || (row > displayRows) || (row > 8)) { return false; }  // page is only 3 bits
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }
+        #endif
+        uint8_t page = row - 1;
+        uint8_t lastColumn = displayWidth - 1;
+        uint8_t setup[7] = { SSD1306_CONTENT_SCROLL_LEFT, 0x00, page, 0x01, page, 0x00, lastColumn };
+        bool ok = ssd1306_writeRawCommands(setup, 7);
+        ok &= ssd1306_writeRowPixels(row, lastColumn, &data, 1);
+        return ok;
+    }
+#endif
+
 #if defined(_SSD1306_CONTROL_CONTRAST)
     void ssd1306_setContrast(const uint8_t value) {
         ssd1306_writeRawCommand2(SSD1306_SET_CONTRAST_CONTROL, value);
@@ -145,7 +447,17 @@ void ssd1306_internalInit() {
 #endif
 
 void ssd1306_clearAll(void) {
-    for (uint8_t i = 0; i < displayRows; i++) {
+    #if defined(_SSD1306_CONTROL_ROTATE)
+        if (displayRotated) {  // page start commands do nothing in horizontal addressing mode
+            for (uint8_t i = 0; i < displayRows; i++) {
+                ssd1306_writeAddress(i, 0);
+                ssd1306_writeRawDataZeros((uint8_t)(displayColumns << 3));
+            }
+            ssd1306_moveTo(1, 1);
+            return;
+        }
+    #endif
+    for (uint8_t i = 0; i < (displayHeight >> 3); i++) {  // pages hidden by zoom too
         ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | i);
         ssd1306_writeRawDataZeros(displayWidth);
     }
@@ -179,8 +491,7 @@ void ssd1306_clearAll(void) {
 #if defined(_SSD1306_FONT_8x8)
     bool ssd1306_clearRow(const uint8_t row) {
         if (ssd1306_moveTo(row, 1)) {
-            ssd1306_writeRawDataZeros(displayWidth);
-            return true;
+            return ssd1306_writeRawDataZeros((uint8_t)(displayColumns << 3));
         }
         return false;
     }
@@ -189,10 +500,10 @@ void ssd1306_clearAll(void) {
 #if defined(_SSD1306_FONT_8x16)
     bool ssd1306_clearRow16(const uint8_t row) {
         if (ssd1306_moveTo(row, 1)) {
-            ssd1306_writeRawDataZeros(displayWidth);
+            bool ok = ssd1306_writeRawDataZeros((uint8_t)(displayColumns << 3));
             if (ssd1306_moveTo(row + 1, 1)) {
-                ssd1306_writeRawDataZeros(displayWidth);
-                return true;
+                ok &= ssd1306_writeRawDataZeros((uint8_t)(displayColumns << 3));
+                return ok;
             }
         }
         return false;
@@ -200,33 +511,57 @@ void ssd1306_clearAll(void) {
 #endif
 
 
+bool ssd1306_writeAddress(const uint8_t row, const uint8_t column) {  // starting from 0, at 8x8 resolution
+    #if defined(_SSD1306_CONTROL_ROTATE)
+        if (displayRotated) {  // row is 8 columns wide window and each character goes to the next page
+            uint8_t window[6] = {
+                SSD1306_SET_COLUMN_ADDRESS, (uint8_t)(row << 3), (uint8_t)((row << 3) + 7),
+                SSD1306_SET_PAGE_ADDRESS, column, displayColumns - 1
+            };
+            return ssd1306_writeRawCommands(window, 6);
+        }
+    #endif
+    uint8_t columnL = (column << 3) & 0x0F;
+    uint8_t columnH = (column >> 1) & 0x0F;
+    bool ok = ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | row);
+    ok &= ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | columnL);
+    ok &= ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | columnH);
+    return ok;
+}
+
 bool ssd1306_moveTo(const uint8_t row, const uint8_t column) {
     if ((row <= displayRows) && (column <= displayColumns)) {
         uint8_t newRow = (row == 0) ? currentRow : row - 1;
         uint8_t newColumn = (column == 0) ? currentColumn : column - 1;
-        uint8_t newColumnL = (newColumn << 3) & 0x0F;
-        uint8_t newColumnH = (newColumn >> 1) & 0x0F;
-        ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | newRow);
-        ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | newColumnL);
-        ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | newColumnH);
+        bool ok = ssd1306_writeAddress(newRow, newColumn);
         currentRow = newRow;
         currentColumn = newColumn;
-        return true;
+        #if defined(_SSD1306_FONT_8x8) && defined(_SSD1306_WRITE_PROPORTIONAL)
+            currentPixel = (uint8_t)(newColumn << 3);
+        #endif
+        return ok;
     }
     return false;
 }
 
 
+uint8_t ssd1306_getRow(void) {
+    return currentRow + 1;
+}
+
+uint8_t ssd1306_getColumn(void) {
+    return currentColumn + 1;
+}
+
+
 #if defined(_SSD1306_FONT_8x8)
     bool ssd1306_moveToNextRow(void) {
         if (currentRow >= displayRows - 1) { return false; }
         uint8_t newRow = currentRow + 1;
-        ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | newRow);
-        ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS);
-        ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS);
+        bool ok = ssd1306_writeAddress(newRow, 0);
         currentRow = newRow;
         currentColumn = 0;
-        return true;
+        return ok;
     }
 #endif
 
@@ -234,89 +569,202 @@ bool ssd1306_moveTo(const uint8_t row, const uint8_t column) {
     bool ssd1306_moveToNextRow16(void) {
         if (currentRow >= displayRows - 1) { return false; }
         uint8_t newRow = currentRow + 2;
-        ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | newRow);
-        ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS);
-        ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS);
+        bool ok = ssd1306_writeAddress(newRow, 0);
         currentRow = newRow;
         currentColumn = 0;
-        return true;
+        return ok;
+    }
+#endif
+
+
+#if defined(_SSD1306_WRITE_ATTRIBUTES)
+    void ssd1306_setAttributes(const uint8_t attributes) {
+        currentAttributes = attributes;
+    }
+
+    uint8_t ssd1306_getAttributes(void) {
+        return currentAttributes;
+    }
+
+    void ssd1306_applyAttributes(const uint8_t* data, uint8_t* output, const uint8_t underlineMask, const uint8_t strikeMask) {  // transforms 8 columns
+        uint8_t mask = 0;
+        if (currentAttributes & SSD1306_ATTRIBUTE_UNDERLINE) { mask |= underlineMask; }
+        if (currentAttributes & SSD1306_ATTRIBUTE_STRIKE) { mask |= strikeMask; }
+        uint8_t invert = (currentAttributes & SSD1306_ATTRIBUTE_INVERSE) ? 0xFF : 0x00;
+        uint8_t previous = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            uint8_t column = data[i];
+            if (currentAttributes & SSD1306_ATTRIBUTE_BOLD) {  // each column also gets pixels of the one on its left
+                uint8_t original = column;
+                column |= previous;
+                previous = original;
+            }
+            output[i] = (uint8_t)((column | mask) ^ invert);
+        }
     }
 #endif
 
+bool ssd1306_writeCellData(const uint8_t* data, const uint8_t underlineMask, const uint8_t strikeMask) {  // 8 bytes of a single cell
+    #if defined(_SSD1306_WRITE_ATTRIBUTES) || defined(_SSD1306_CONTROL_ROTATE)
+        uint8_t cell[8];
+    #endif
+    #if defined(_SSD1306_WRITE_ATTRIBUTES)
+        if (currentAttributes != 0) {
+            ssd1306_applyAttributes(data, cell, underlineMask, strikeMask);
+            data = cell;
+        }
+    #else
+        (void)underlineMask; (void)strikeMask;
+    #endif
+    #if defined(_SSD1306_CONTROL_ROTATE)
+        if (displayRotated) {
+            if (data != cell) {
+                for (uint8_t i = 0; i < 8; i++) { cell[i] = data[i]; }
+            }
+            ssd1306_transpose(cell);
+            data = cell;
+        }
+    #endif
+    return ssd1306_writeRawData(data, 8);
+}
 
 bool ssd1306_drawCustom(const uint8_t* data) {  // always present since it's used by other functions
     if (currentColumn >= displayColumns) { return false; }
 
-    ssd1306_writeRawData(data, 8);
+    bool ok = ssd1306_writeCellData(data, SSD1306_UNDERLINE_MASK, SSD1306_STRIKE_MASK_8);
     currentColumn++;
 
-    return true;
+    return ok;
 }
 
 
 #if defined(_SSD1306_FONT_8x8)
-    bool ssd1306_writeCharacter(const char value) {
+    const uint8_t* ssd1306_getCharacter(const char value) {
         if (value < 32) {
             #if defined(_SSD1306_FONT_8x8_LOW)
                 uint16_t offset = (uint16_t)(value << 3);  // *8
-                return ssd1306_drawCustom(&font_low_8x8[offset]);
+                return &font_low_8x8[offset];
             #else
-                return ssd1306_drawCustom(&font_basic_8x8[0]);
+                return &font_basic_8x8[0];
             #endif
         } else if (value > 126) {
             #if defined(_SSD1306_FONT_8x8_HIGH)
                 uint16_t offset = (uint16_t)((value - 127) << 3);  // *8
-                return ssd1306_drawCustom(&font_high_8x8[offset]);
+                return &font_high_8x8[offset];
             #else
-                return ssd1306_drawCustom(&font_basic_8x8[0]);
+                return &font_basic_8x8[0];
             #endif
         } else {
             uint16_t offset = (uint16_t)((value - 32) << 3);  // *8
-            return ssd1306_drawCustom(&font_basic_8x8[offset]);
+            return &font_basic_8x8[offset];
         }
     }
+
+    bool ssd1306_writeCharacter(const char value) {
+        return ssd1306_drawCustom(ssd1306_getCharacter(value));
+    }
 #endif
 
 #if defined(_SSD1306_FONT_8x16)
     bool ssd1306_drawCustom16(const uint8_t* data) {
         if (currentColumn >= displayColumns) { return false; }
 
-        ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (currentRow + 1));
-        ssd1306_writeRawData(data + 8, 8);
+        bool ok;
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) {  // lower row is in another column window
+                ok = ssd1306_writeAddress(currentRow + 1, currentColumn);
+            } else {
+                ok = ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (currentRow + 1));
+            }
+        #else
+            ok = ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (currentRow + 1));
+        #endif
+        ok &= ssd1306_writeCellData(data + 8, SSD1306_UNDERLINE_MASK, 0);
 
-        uint8_t currentColumnLow = (currentColumn << 3) & 0x0F;
-        uint8_t currentColumnHigh = (currentColumn >> 1) & 0x0F;
-        ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | currentRow);
-        ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | currentColumnLow);
-        ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | currentColumnHigh);
-        ssd1306_writeRawData(data, 8);
+        ok &= ssd1306_writeAddress(currentRow, currentColumn);
+        ok &= ssd1306_writeCellData(data, 0, SSD1306_STRIKE_MASK_16);
         currentColumn++;
 
-        return true;
+        return ok;
     }
 
-    bool ssd1306_writeCharacter16(const char value) {
-        if (value < 32) {
-            #if defined(_SSD1306_FONT_8x16_LOW)
-                uint16_t offset = (uint16_t)(value << 4);  // *16
-                return ssd1306_drawCustom16(&font_low_8x16[offset]);
-            #else
-                return ssd1306_drawCustom16(&font_basic_8x16[0]);
-            #endif
-        } else if (value > 126) {
-            #if defined(_SSD1306_FONT_8x16_HIGH)
-                uint16_t offset = (uint16_t)((value - 127) << 4);  // *16
-                return ssd1306_drawCustom16(&font_high_8x16[offset]);
-            #else
-                return ssd1306_drawCustom16(&font_basic_8x16[0]);
-            #endif
-        } else {
-            uint16_t offset = (uint16_t)((value - 32) << 4);  // *16
-            return ssd1306_drawCustom16(&font_basic_8x16[offset]);
+    #if defined(_SSD1306_FONT_8x16_DERIVED) || (defined(_SSD1306_FONT_8x8_LOW) && !defined(_SSD1306_FONT_8x16_LOW)) || (defined(_SSD1306_FONT_8x8_HIGH) && !defined(_SSD1306_FONT_8x16_HIGH))
+        const uint8_t ssd1306_doubleNibble[16] = {  // each bit repeated twice
+            0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F, 0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF
+        };
+        uint8_t derivedCharacter16[16];
+
+        const uint8_t* ssd1306_deriveCharacter16(const char value) {  // valid until the next call
+            const uint8_t* data = ssd1306_getCharacter(value);
+            for (uint8_t i = 0; i < 8; i++) {
+                derivedCharacter16[i] = ssd1306_doubleNibble[data[i] & 0x0F];
+                derivedCharacter16[i + 8] = ssd1306_doubleNibble[data[i] >> 4];
+            }
+            return &derivedCharacter16[0];
+        }
+    #endif
+
+    #if defined(_SSD1306_FONT_8x16_DERIVED)
+        const uint8_t* ssd1306_getCharacter16(const char value) {
+            return ssd1306_deriveCharacter16(value);
+        }
+    #else
+        const uint8_t* ssd1306_getCharacter16(const char value) {
+            if (value < 32) {
+                #if defined(_SSD1306_FONT_8x16_LOW)
+                    uint16_t offset = (uint16_t)(value << 4);  // *16
+                    return &font_low_8x16[offset];
+                #elif defined(_SSD1306_FONT_8x8_LOW)
+                    return ssd1306_deriveCharacter16(value);
+                #else
+                    return &font_basic_8x16[0];
+                #endif
+            } else if (value > 126) {
+                #if defined(_SSD1306_FONT_8x16_HIGH)
+                    uint16_t offset = (uint16_t)((value - 127) << 4);  // *16
+                    return &font_high_8x16[offset];
+                #elif defined(_SSD1306_FONT_8x8_HIGH)
+                    return ssd1306_deriveCharacter16(value);
+                #else
+                    return &font_basic_8x16[0];
+                #endif
+            } else {
+                uint16_t offset = (uint16_t)((value - 32) << 4);  // *16
+                return &font_basic_8x16[offset];
+            }
         }
+    #endif
+
+    bool ssd1306_writeCharacter16(const char value) {
+        return ssd1306_drawCustom16(ssd1306_getCharacter16(value));
+    }
+
+    bool ssd1306_writeCharacterHalf16(const char value, const bool lowerHalf) {
+        const uint8_t* data = ssd1306_getCharacter16(value);
+        return ssd1306_drawCustom(lowerHalf ? data + 8 : data);
+    }
+#endif
+
+#if defined(_SSD1306_FONT_3x5)
+    const uint8_t* ssd1306_getMiniCharacter(char value) {
+        if ((value >= 'a') && (value <= 'z')) { value -= 32; }  // font has no lower case
+        if ((value < 32) || (value > 95)) { value = 32; }
+        return &font_mini_3x5[(uint8_t)((value - 32) * 3)];
+    }
+
+    bool ssd1306_writeMiniCharacters(const char left, const char right) {
+        uint8_t data[8];  // each character gets one empty column on its right
+        const uint8_t* glyph = ssd1306_getMiniCharacter(left);
+        for (uint8_t i = 0; i < 3; i++) { data[i] = glyph[i]; }
+        data[3] = 0;
+        glyph = ssd1306_getMiniCharacter(right);
+        for (uint8_t i = 0; i < 3; i++) { data[i + 4] = glyph[i]; }
+        data[7] = 0;
+        return ssd1306_drawCustom(data);
     }
 #endif
 
+
 #if defined(_SSD1306_FONT_8x8)
     bool ssd1306_writeText(const char* text) {
         bool ok = true;
@@ -363,22 +811,23 @@ bool ssd1306_drawCustom(const uint8_t* data) {  // always present since it's use
             dataInverse[i] = ~data[i];
         }
 
+        bool ok = true;
         if (count >= 16) {
-            ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (currentRow + 1));
-            ssd1306_writeRawData(dataInverse + 8, 8);
+            ok &= ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (currentRow + 1));
+            ok &= ssd1306_writeRawData(dataInverse + 8, 8);
 
             uint8_t currentColumnLow = (currentColumn << 3) & 0x0F;
             uint8_t currentColumnHigh = (currentColumn >> 1) & 0x0F;
-            ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | currentRow);
-            ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | currentColumnLow);
-            ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | currentColumnHigh);
-            ssd1306_writeRawData(dataInverse, 8);
+            ok &= ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | currentRow);
+            ok &= ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | currentColumnLow);
+            ok &= ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | currentColumnHigh);
+            ok &= ssd1306_writeRawData(dataInverse, 8);
         } else {
-            ssd1306_writeRawData(dataInverse, 8);
+            ok &= ssd1306_writeRawData(dataInverse, 8);
         }
         currentColumn++;
 
-        return true;
+        return ok;
     }
 #endif
 
@@ -407,24 +856,7 @@ bool ssd1306_drawCustom(const uint8_t* data) {  // always present since it's use
 
 #if defined(_SSD1306_FONT_8x16) && defined(_SSD1306_WRITE_INVERSE)
     bool ssd1306_writeInverseCharacter16(const char value) {
-        if (value < 32) {
-            #if defined(_SSD1306_FONT_8x16_LOW)
-                uint16_t offset = (uint16_t)(value << 4);  // *16
-                return ssd1306_drawInverseCharacter(&font_low_8x16[offset], 16);
-            #else
-                return ssd1306_drawInverseCharacter(&font_basic_8x16[0], 16);
-            #endif
-        } else if (value > 126) {
-            #if defined(_SSD1306_FONT_8x16_HIGH)
-                uint16_t offset = (uint16_t)((value - 127) << 4);  // *16
-                return ssd1306_drawInverseCharacter(&font_high_8x16[offset], 16);
-            #else
-                return ssd1306_drawInverseCharacter(&font_basic_8x16[0], 16);
-            #endif
-        } else {
-            uint16_t offset = (uint16_t)((value - 32) << 4);  // *16
-            return ssd1306_drawInverseCharacter(&font_basic_8x16[offset], 16);
-        }
+        return ssd1306_drawInverseCharacter(ssd1306_getCharacter16(value), 16);
     }
 #endif
 
@@ -463,6 +895,183 @@ bool ssd1306_drawCustom(const uint8_t* data) {  // always present since it's use
 #endif
 
 
+#if defined(_SSD1306_WRITE_SHIFTED)
+    bool ssd1306_drawCustomShifted(const uint8_t* data, const uint8_t shift, const uint8_t* above, const uint8_t* below) {
+        if (currentColumn >= displayColumns) { return false; }
+        if (shift == 0) { return ssd1306_drawCustom(data); }
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }  // written only as is
+        #endif
+
+        uint8_t keepMask = (uint8_t)((1 << shift) - 1);  // pixels above the character in the current row
+        uint8_t upper[8];
+        uint8_t lower[8];
+        for (uint8_t i = 0; i < 8; i++) {
+            uint16_t shifted = (uint16_t)data[i] << shift;
+            upper[i] = (uint8_t)shifted | ((above != NULL) ? (above[i] & keepMask) : 0);
+            lower[i] = (uint8_t)(shifted >> 8) | ((below != NULL) ? (below[i] & (uint8_t)~keepMask) : 0);
+        }
+
+        bool ok = true;
+        if (currentRow + 1 < displayRows) {  // last row has nothing below
+            ok &= ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | (currentRow + 1));
+            ok &= ssd1306_writeRawData(lower, 8);
+        }
+
+        uint8_t currentColumnLow = (currentColumn << 3) & 0x0F;
+        uint8_t currentColumnHigh = (currentColumn >> 1) & 0x0F;
+        ok &= ssd1306_writeRawCommand1(SSD1306_SET_PAGE_START_ADDRESS | currentRow);
+        ok &= ssd1306_writeRawCommand1(SSD1306_SET_LOWER_START_COLUMN_ADDRESS | currentColumnLow);
+        ok &= ssd1306_writeRawCommand1(SSD1306_SET_UPPER_START_COLUMN_ADDRESS | currentColumnHigh);
+        ok &= ssd1306_writeRawData(upper, 8);
+        currentColumn++;
+
+        return ok;
+    }
+#endif
+
+
+#if defined(_SSD1306_FONT_8x8) && defined(_SSD1306_WRITE_PROPORTIONAL)
+    bool ssd1306_moveToPixel(const uint8_t row, const uint8_t x) {
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }  // written only as is
+        #endif
+        if (x >= displayWidth) { return false; }
+        uint8_t column = (uint8_t)((x + 7) >> 3);
+        bool ok;
+        if (column < displayColumns) {
+            ok = ssd1306_moveTo(row, column + 1);
+        } else {  // nothing but proportional text fits after it
+            ok = ssd1306_moveTo(row, displayColumns);
+            currentColumn = column;
+        }
+        currentPixel = x;
+        return ok;
+    }
+
+    uint8_t ssd1306_getPixel(void) {
+        if ((uint8_t)((currentPixel + 7) >> 3) == currentColumn) { return currentPixel; }
+        return (uint8_t)(currentColumn << 3);  // something else was written since
+    }
+
+    uint8_t ssd1306_getUsedColumns(const uint8_t* data, uint8_t* first) {  // returns 0 if character is blank
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (data[i] != 0) {
+                if (count == 0) { *first = i; }
+                count = (uint8_t)(i - *first + 1);
+            }
+        }
+        return count;
+    }
+
+    uint8_t ssd1306_getCharacterWidth(const char value) {
+        uint8_t first;
+        uint8_t count = ssd1306_getUsedColumns(ssd1306_getCharacter(value), &first);
+        return (count != 0) ? count + 1 : 3;  // blank character is as wide as a narrow one
+    }
+
+    bool ssd1306_writeProportionalText(const char* text) {
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }  // written only as is
+        #endif
+        uint8_t x = ssd1306_getPixel();
+        uint16_t width = 0;
+        for (const char* next = text; *next != 0; next++) {
+            width += ssd1306_getCharacterWidth(*next);
+        }
+        if (x + width > displayWidth) { return false; }
+
+        uint8_t position[2] = { SSD1306_SET_LOWER_START_COLUMN_ADDRESS | (x & 0x0F), SSD1306_SET_UPPER_START_COLUMN_ADDRESS | (x >> 4) };
+        bool ok = ssd1306_writeRawCommands(position, 2);
+        while (*text != 0) {
+            const uint8_t* data = ssd1306_getCharacter(*text);
+            uint8_t first;
+            uint8_t count = ssd1306_getUsedColumns(data, &first);
+            if (count != 0) {
+                uint8_t columns[9];  // used columns followed by spacing
+                for (uint8_t i = 0; i < count; i++) { columns[i] = data[first + i]; }
+                columns[count++] = 0;
+                ok &= ssd1306_writeRawData(columns, count);
+            } else {
+                count = 3;
+                ok &= ssd1306_writeRawDataZeros(count);
+            }
+            x += count;
+            text++;
+        }
+
+        currentPixel = x;
+        currentColumn = (uint8_t)((x + 7) >> 3);
+        if (currentColumn < displayColumns) {  // other writes expect whole columns
+            position[0] = SSD1306_SET_LOWER_START_COLUMN_ADDRESS | ((currentColumn << 3) & 0x0F);
+            position[1] = SSD1306_SET_UPPER_START_COLUMN_ADDRESS | ((currentColumn >> 1) & 0x0F);
+            ok &= ssd1306_writeRawCommands(position, 2);
+        }
+        return ok;
+    }
+#endif
+
+
+#if defined(_SSD1306_FONT_8x8) && defined(_SSD1306_WRITE_SCALED)
+    const uint16_t ssd1306_scaleNibble[3][16] = {  // each bit repeated 2x, 3x, or 4x
+        { 0x0000, 0x0003, 0x000C, 0x000F, 0x0030, 0x0033, 0x003C, 0x003F, 0x00C0, 0x00C3, 0x00CC, 0x00CF, 0x00F0, 0x00F3, 0x00FC, 0x00FF },
+        { 0x0000, 0x0007, 0x0038, 0x003F, 0x01C0, 0x01C7, 0x01F8, 0x01FF, 0x0E00, 0x0E07, 0x0E38, 0x0E3F, 0x0FC0, 0x0FC7, 0x0FF8, 0x0FFF },
+        { 0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF, 0xF000, 0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF },
+    };
+
+    bool ssd1306_writeCharacterScaled(const char value, const uint8_t scale) {
+        #if defined(_SSD1306_CONTROL_ROTATE)
+            if (displayRotated) { return false; }  // written only as is
+        #endif
+        if ((scale < 2) || (scale > 4)) { return false; }
+        if ((currentColumn + scale > displayColumns) || (currentRow + scale > displayRows)) { return false; }
+
+        const uint8_t* glyph = &font_basic_8x8[0];
+        if ((value >= 32) && (value <= 126)) { glyph = &font_basic_8x8[(uint16_t)((value - 32) << 3)]; }
+
+        uint8_t firstPixel = (uint8_t)(currentColumn << 3);
+        uint8_t lastPixel = (uint8_t)(((currentColumn + scale) << 3) - 1);
+        uint8_t window[8] = {  // horizontal addressing moves to the next page on its own
+            SSD1306_SET_MEMORY_ADDRESSING_MODE, 0b00,
+            SSD1306_SET_COLUMN_ADDRESS, firstPixel, lastPixel,
+            SSD1306_SET_PAGE_ADDRESS, currentRow, (uint8_t)(currentRow + scale - 1)
+        };
+        bool ok = ssd1306_writeRawCommands(window, 8);
+
+        const uint16_t* table = ssd1306_scaleNibble[scale - 2];
+        uint8_t nibbleShift = (uint8_t)(scale << 2);
+        for (uint8_t page = 0; page < scale; page++) {
+            uint8_t data[32];  // one page of 4x character
+            uint8_t* next = data;
+            uint8_t pageShift = (uint8_t)(page << 3);
+            for (uint8_t i = 0; i < 8; i++) {
+                uint8_t column = glyph[i];
+                uint32_t scaled = table[column & 0x0F] | ((uint32_t)table[column >> 4] << nibbleShift);
+                uint8_t pageData = (uint8_t)(scaled >> pageShift);
+                for (uint8_t j = 0; j < scale; j++) { *next++ = pageData; }
+            }
+            ok &= ssd1306_writeRawData(data, (uint8_t)(scale << 3));
+        }
+
+        window[1] = 0b10;  // back to page addressing over the whole display
+        window[3] = 0;
+        window[4] = displayWidth - 1;
+        window[6] = 0;
+        window[7] = displayRows - 1;
+        ok &= ssd1306_writeRawCommands(window, 8);
+
+        uint8_t newColumn = currentColumn + scale;
+        if (newColumn < displayColumns) {
+            ok &= ssd1306_moveTo(currentRow + 1, newColumn + 1);
+        } else {  // nothing more fits in this row anyhow
+            currentColumn = newColumn;
+        }
+        return ok;
+    }
+#endif
+
+
 #if defined(_SSD1306_WRITE_PROGRESS)
     bool ssd1306_writeProgress(const uint8_t characterCount, const uint8_t percentValue) {
         if ((characterCount == 0) || (characterCount > 16)) { return false; }
@@ -519,19 +1128,82 @@ bool ssd1306_drawCustom(const uint8_t* data) {  // always present since it's use
 #endif
 
 
-void ssd1306_writeRawCommand1(const uint8_t datum1) {
-    i2c_master_writeRegisterBytes(displayAddress, 0x00, &datum1, 1);
+#if (_SSD1306_DISPLAY_COUNT > 1)
+    void ssd1306_writeRawMirror(const uint8_t control, const uint8_t* data, const uint8_t count) {  // data of NULL writes zeros; failures never count against selected display
+        for (uint8_t i = 0; i < _SSD1306_DISPLAY_COUNT; i++) {
+            uint8_t bit = (uint8_t)(1 << i);
+            if ((displayMirror & bit) == 0) { continue; }
+            DisplayContext* context = &displayContexts[i];
+            if (ssd1306_writeTransport(context->Address, control, data, count)) {
+                context->MirrorErrors = 0;
+            } else if (++context->MirrorErrors >= SSD1306_MIRROR_ERROR_MAX) {  // probably gone; don't keep the bus busy with it
+                displayMirror &= (uint8_t)~bit;
+                displayMirrorLost |= bit;
+            }
+        }
+    }
+#endif
+
+bool ssd1306_writeTransport(const uint8_t address, const uint8_t control, const uint8_t* data, const uint8_t count) {  // data of NULL writes zeros
+    #if defined(_SSD1306_TRANSPORT_SPI)
+        if (displayTransport == SSD1306_TRANSPORT_SPI) {  // control byte becomes data/command pin
+            return spi_master_writeBytes(address, (control == 0x40), data, count);
+        }
+    #endif
+    if (data != NULL) {
+        return i2c_master_writeRegisterBytes(address, control, data, count);
+    } else {
+        return i2c_master_writeRegisterZeroBytes(address, control, count);
+    }
+}
+
+bool ssd1306_countError(void) {
+    if (writeErrorCount < 0xFF) { writeErrorCount++; }
+    return false;
+}
+
+bool ssd1306_writeRawCommand1(const uint8_t datum1) {
+    bool ok = ssd1306_writeTransport(displayAddress, 0x00, &datum1, 1);
+    #if (_SSD1306_DISPLAY_COUNT > 1)
+        if (displayMirror != 0) { ssd1306_writeRawMirror(0x00, &datum1, 1); }
+    #endif
+    if (!ok) { return ssd1306_countError(); }
+    return true;
 }
 
-void ssd1306_writeRawCommand2(const uint8_t datum1, const uint8_t datum2) {
+bool ssd1306_writeRawCommand2(const uint8_t datum1, const uint8_t datum2) {
     uint8_t data[2] = { datum1, datum2 };
-    i2c_master_writeRegisterBytes(displayAddress, 0x00, data, 2);
+    bool ok = ssd1306_writeTransport(displayAddress, 0x00, data, 2);
+    #if (_SSD1306_DISPLAY_COUNT > 1)
+        if (displayMirror != 0) { ssd1306_writeRawMirror(0x00, data, 2); }
+    #endif
+    if (!ok) { return ssd1306_countError(); }
+    return true;
 }
 
-void ssd1306_writeRawData(const uint8_t *data, const uint8_t count) {
-    i2c_master_writeRegisterBytes(displayAddress, 0x40, data, count);
+bool ssd1306_writeRawCommands(const uint8_t* data, const uint8_t count) {
+    bool ok = ssd1306_writeTransport(displayAddress, 0x00, data, count);
+    #if (_SSD1306_DISPLAY_COUNT > 1)
+        if (displayMirror != 0) { ssd1306_writeRawMirror(0x00, data, count); }
+    #endif
+    if (!ok) { return ssd1306_countError(); }
+    return true;
 }
 
-void ssd1306_writeRawDataZeros(const uint8_t count) {
-    i2c_master_writeRegisterZeroBytes(displayAddress, 0x40, count);
+bool ssd1306_writeRawData(const uint8_t *data, const uint8_t count) {
+    bool ok = ssd1306_writeTransport(displayAddress, 0x40, data, count);
+    #if (_SSD1306_DISPLAY_COUNT > 1)
+        if (displayMirror != 0) { ssd1306_writeRawMirror(0x40, data, count); }
+    #endif
+    if (!ok) { return ssd1306_countError(); }
+    return true;
+}
+
+bool ssd1306_writeRawDataZeros(const uint8_t count) {
+    bool ok = ssd1306_writeTransport(displayAddress, 0x40, NULL, count);
+    #if (_SSD1306_DISPLAY_COUNT > 1)
+        if (displayMirror != 0) { ssd1306_writeRawMirror(0x40, NULL, count); }
+    #endif
+    if (!ok) { return ssd1306_countError(); }
+    return true;
 }
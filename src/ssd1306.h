@@ -1,4 +1,20 @@
 /* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+// 2024-12-04: Content scroll needs its own define; added writing pixel columns into a row
+// 2024-12-02: Mirroring requires matching geometry and drops mirrors that keep failing
+// 2024-11-30: Added zoom
+// 2024-11-28: Added horizontal scrolling
+// 2024-11-26: Added rotation by 90 degrees
+// 2024-11-24: Added character attributes (inverse, bold, underline, strike-through)
+// 2024-11-22: Missing 8x16 control and CP437 characters are derived from 8x8
+// 2024-11-20: Added 8x16 font derived from 8x8
+// 2024-11-18: Added 3x5 mini font
+// 2024-11-16: Added pixel positioning and proportional text
+// 2024-11-14: Added characters shifted by pixels
+// 2024-11-12: Added scaled characters
+// 2024-11-10: Added SPI transport
+// 2024-11-08: Added writing half of 8x16 character
+// 2024-11-06: Added probing and error counting
+// 2024-11-04: Added multiple display contexts and mirroring
 // 2024-10-15: Adjusted for 128x128 display
 // 2024-09-26: Added inverse writing
 //             Added progress bar
@@ -19,15 +35,27 @@
  *   _SSD1306_FONT_8x8_LOW:        Include lower 32 ASCII control characters
  *   _SSD1306_FONT_8x8_HIGH:       Include upper 128 CP437 ASCII characters
  *   _SSD1306_FONT_8x16:           Use 16-pixel high text
- *   _SSD1306_FONT_8x16_LOW:       Include lower 32 ASCII control characters
- *   _SSD1306_FONT_8x16_HIGH:      Include upper 128 CP437 ASCII characters
+ *   _SSD1306_FONT_8x16_LOW:       Include lower 32 ASCII control characters; derived from 8x8 if only that one is present
+ *   _SSD1306_FONT_8x16_HIGH:      Include upper 128 CP437 ASCII characters; derived from 8x8 if only that one is present
+ *   _SSD1306_FONT_8x16_DERIVED:   Produce 16-pixel high text by doubling 8x8 font instead of storing it
+ *   _SSD1306_FONT_3x5:            Use 3x5 text, two characters per 8x8 column
  *   _SSD1306_WRITE_INVERSE:       Allows inverse writes
  *   _SSD1306_WRITE_PROGRESS:      Allows writing progress bar
+ *   _SSD1306_WRITE_SCALED:        Allows writing 8x8 characters scaled 2x, 3x, or 4x
+ *   _SSD1306_WRITE_SHIFTED:       Allows writing 8x8 characters shifted down by pixels
+ *   _SSD1306_WRITE_PROPORTIONAL:  Allows pixel positioning and proportional 8x8 text
+ *   _SSD1306_WRITE_ATTRIBUTES:    Allows inverse, bold, underline, and strike-through attributes for characters
  *   _SSD1306_CONTROL_DISPLAY:     Allows display control (displayOff, displayOn)
  *   _SSD1306_CONTROL_INVERT:      Allows display control (displayInvert, displayNormal)
  *   _SSD1306_CONTROL_FLIP:        Allows display control (displayFlip)
+ *   _SSD1306_CONTROL_ROTATE:      Allows display rotation by 90 degrees (displayRotate)
+ *   _SSD1306_CONTROL_ZOOM:        Allows doubling display height (displayZoom, isZoomed)
+ *   _SSD1306_CONTROL_SCROLL:      Allows horizontal scrolling (scrollStart, scrollStop, writeRowPixels)
+ *   _SSD1306_CONTROL_CONTENT_SCROLL: Allows content scroll by a single column (scrollRowLeft); needs SSD1306B or newer controller
  *   _SSD1306_CONTROL_CONTRAST:    Allows contrast control (setContrast)
  *   _SSD1306_CUSTOM_INIT:         Uses customizable initialization function
+ *   _SSD1306_DISPLAY_COUNT <N>:   Number of displays on the same bus; default is 1
+ *   _SSD1306_TRANSPORT_SPI:       Allows 4-wire SPI transport (setTransport)
  */
 
 #pragma once
@@ -41,10 +69,17 @@
     #define _SSD1306_FONT_8x8
 #endif
 
+#if defined(_SSD1306_FONT_8x16_DERIVED) && !defined(_SSD1306_FONT_8x8)
+    #error SSD1306 derived 8x16 font requires 8x8 font
+#endif
+
 
 /** Initializes Display. */
 #if defined(_SSD1306_CUSTOM_INIT)
     void ssd1306_init(const uint8_t address, const uint8_t width, const uint8_t height);
+
+    /** Returns true if display at given address acknowledges a no-op command. Selected display is not changed. */
+    bool ssd1306_probe(const uint8_t address);
 #else
     void ssd1306_init(void);
 
@@ -65,6 +100,39 @@
     #endif
 #endif
 
+#if !defined(_SSD1306_DISPLAY_COUNT)
+    #define _SSD1306_DISPLAY_COUNT  1
+#elif (_SSD1306_DISPLAY_COUNT < 1) || (_SSD1306_DISPLAY_COUNT > 8)
+    #error SSD1306 display count not supported
+#elif (_SSD1306_DISPLAY_COUNT > 1) && !defined(_SSD1306_CUSTOM_INIT)
+    #error SSD1306 multiple displays require custom initialization
+#endif
+
+#if (_SSD1306_DISPLAY_COUNT > 1)
+    /** Selects display (starting from 0) all further calls will use. Mirroring is turned off. */
+    void ssd1306_selectDisplay(const uint8_t index);
+
+    /** Returns selected display (starting from 0). */
+    uint8_t ssd1306_getDisplay(void);
+
+    /** Sends everything written to the selected display also to the displays in mask (bit per display). Returns false and mirrors nothing if any of them differs in size, rotation, or zoom. */
+    bool ssd1306_setMirror(const uint8_t mask);
+
+    /** Returns displays (bit per display) dropped from mirroring since the last call because their writes kept failing. */
+    uint8_t ssd1306_takeMirrorLost(void);
+#endif
+
+#if defined(_SSD1306_TRANSPORT_SPI)
+    #define SSD1306_TRANSPORT_I2C  0
+    #define SSD1306_TRANSPORT_SPI  1
+
+    /** Selects how displays are connected; default is I2C. With SPI, display address selects chip select line and probing always succeeds. */
+    void ssd1306_setTransport(const uint8_t transport);
+#endif
+
+/** Returns count of failed writes to the selected display since the last call; mirrors are not counted. */
+uint8_t ssd1306_takeErrorCount(void);
+
 /** Turns display off. */
 #if defined(_SSD1306_CONTROL_DISPLAY)
     void ssd1306_displayOff(void);
@@ -85,11 +153,40 @@
     void ssd1306_displayNormal(void);
 #endif
 
-/** Flips display orientation. */
+/** Flips display orientation. Rotated display is turned by 270 degrees instead of 90. */
 #if defined(_SSD1306_CONTROL_FLIP)
     void ssd1306_displayFlip(bool flipped);
 #endif
 
+/** Rotates display by 90 degrees so rows run along its width; flip has to be set afterward. Scaled, shifted, and proportional writes are not supported while rotated. */
+#if defined(_SSD1306_CONTROL_ROTATE)
+    void ssd1306_displayRotate(const bool rotated);
+#endif
+
+#if defined(_SSD1306_CONTROL_ZOOM)
+    /** Shows each pixel row twice so only half of the rows remain and 8x8 text looks 8x16; cursor moves to the first row. Works only for 64 pixel high display that is not rotated. Rows below are kept and show again once zoom is off. */
+    bool ssd1306_displayZoom(const bool zoomed);
+
+    /** Returns true if display is zoomed. */
+    bool ssd1306_isZoomed(void);
+#endif
+
+#if defined(_SSD1306_CONTROL_SCROLL)
+    /** Starts continuous hardware scroll of given rows (at 8x8 resolution, up to 8) at speed 0 (slowest) to 7 (fastest). Written content scrolls too; it stays moved once stopped. */
+    bool ssd1306_scrollStart(const uint8_t firstRow, const uint8_t lastRow, const uint8_t speed, const bool left);
+
+    /** Stops continuous hardware scroll. */
+    bool ssd1306_scrollStop(void);
+
+    /** Writes pixel columns as they are into given row (at 8x8 resolution, up to 8) starting at pixel column x. Attributes are not applied and cursor stays where it was. */
+    bool ssd1306_writeRowPixels(const uint8_t row, const uint8_t x, const uint8_t* data, const uint8_t count);
+#endif
+
+#if defined(_SSD1306_CONTROL_SCROLL) && defined(_SSD1306_CONTROL_CONTENT_SCROLL)
+    /** Moves content of given row (at 8x8 resolution, up to 8) one pixel to the left and writes data into its last column; needs controller with content scroll (2Ch/2Dh). Cursor stays where it was. */
+    bool ssd1306_scrollRowLeft(const uint8_t row, const uint8_t data);
+#endif
+
 /** Sets contrast value. */
 #if defined(_SSD1306_CONTROL_CONTRAST)
     void ssd1306_setContrast(const uint8_t value);
@@ -98,6 +195,12 @@
 /** Sets column and row to be used (at 8x8 resolution). */
 bool ssd1306_moveTo(const uint8_t row, const uint8_t column);
 
+/** Returns current row (at 8x8 resolution, starting from 1). */
+uint8_t ssd1306_getRow(void);
+
+/** Returns current column (at 8x8 resolution, starting from 1). */
+uint8_t ssd1306_getColumn(void);
+
 
 /** Moves cursor to the first column of the next row. */
 #if defined(_SSD1306_FONT_8x8)
@@ -139,7 +242,23 @@ void ssd1306_clearAll(void);
 /** Writes custom 8x8 character at the current position from 8 bytes given. */
 bool ssd1306_drawCustom(const uint8_t* data);
 
+#if defined(_SSD1306_WRITE_ATTRIBUTES)
+    #define SSD1306_ATTRIBUTE_INVERSE    0x01
+    #define SSD1306_ATTRIBUTE_BOLD       0x02
+    #define SSD1306_ATTRIBUTE_UNDERLINE  0x04
+    #define SSD1306_ATTRIBUTE_STRIKE     0x08
+
+    /** Sets attributes applied to custom, 8x8, and 8x16 characters that follow. */
+    void ssd1306_setAttributes(const uint8_t attributes);
+
+    /** Returns attributes currently applied. */
+    uint8_t ssd1306_getAttributes(void);
+#endif
+
 #if defined(_SSD1306_FONT_8x8)
+    /** Returns 8 bytes of 8x8 character. */
+    const uint8_t* ssd1306_getCharacter(const char value);
+
     /** Writes 8x8 character at the current position */
     bool ssd1306_writeCharacter(const char value);
 
@@ -153,9 +272,15 @@ bool ssd1306_drawCustom(const uint8_t* data);
     /** Writes custom 8x16 character at the current position from 8 bytes given. */
     bool ssd1306_drawCustom16(const uint8_t* data);
 
+    /** Returns 16 bytes of 8x16 character (upper half first). Derived character is only valid until the next call. */
+    const uint8_t* ssd1306_getCharacter16(const char value);
+
     /** Writes 8x16 character at the current position */
     bool ssd1306_writeCharacter16(const char value);
 
+    /** Writes upper or lower half of 8x16 character at the current position as 8x8 character */
+    bool ssd1306_writeCharacterHalf16(const char value, const bool lowerHalf);
+
     #if defined _SSD1306_WRITE_INVERSE
         /** Writes inverse 8x16 character at the current position */
         bool ssd1306_writeInverseCharacter16(const char value);
@@ -163,6 +288,12 @@ bool ssd1306_drawCustom(const uint8_t* data);
 #endif
 
 
+#if defined(_SSD1306_FONT_3x5)
+    /** Writes two 3x5 characters at the current position as one 8x8 character. Lower case is written as upper case. */
+    bool ssd1306_writeMiniCharacters(const char left, const char right);
+#endif
+
+
 #if defined(_SSD1306_FONT_8x8)
     /** Writes 8x8 text at the current position */
     bool ssd1306_writeText(const char* text);
@@ -204,6 +335,33 @@ bool ssd1306_drawCustom(const uint8_t* data);
 #endif
 
 
+#if defined(_SSD1306_FONT_8x8) && defined(_SSD1306_WRITE_SCALED)
+    /** Writes 8x8 character scaled 2x, 3x, or 4x at the current position; it covers scale rows and columns. Cursor stays in the same row. */
+    bool ssd1306_writeCharacterScaled(const char value, const uint8_t scale);
+#endif
+
+
+#if defined(_SSD1306_WRITE_SHIFTED)
+    /** Writes custom 8x8 character at the current position moved down by shift pixels (0-7) into the next row. Pixels around it come from above (8 bytes shown in the current row) and below (8 bytes shown in the next row); NULL is blank. */
+    bool ssd1306_drawCustomShifted(const uint8_t* data, const uint8_t shift, const uint8_t* above, const uint8_t* below);
+#endif
+
+
+#if defined(_SSD1306_FONT_8x8) && defined(_SSD1306_WRITE_PROPORTIONAL)
+    /** Sets row (at 8x8 resolution) and pixel column (starting from 0) to be used by proportional text. Other writes continue from the first whole column after it. */
+    bool ssd1306_moveToPixel(const uint8_t row, const uint8_t x);
+
+    /** Returns pixel column (starting from 0) proportional text would continue from. */
+    uint8_t ssd1306_getPixel(void);
+
+    /** Returns width in pixels of proportional 8x8 character including one pixel of spacing. */
+    uint8_t ssd1306_getCharacterWidth(const char value);
+
+    /** Writes text at the current pixel position using only the columns each 8x8 character uses. Nothing is written if it doesn't fit. */
+    bool ssd1306_writeProportionalText(const char* text);
+#endif
+
+
 #if defined(_SSD1306_WRITE_PROGRESS)
     /** Writes progress bar with a given value */
     bool ssd1306_writeProgress(const uint8_t characterCount, const uint8_t percentValue);
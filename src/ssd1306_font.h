@@ -9,7 +9,7 @@
         extern const uint8_t font_high_8x8[];
     #endif
 #endif
-#if defined(_SSD1306_FONT_8x16)
+#if defined(_SSD1306_FONT_8x16) && !defined(_SSD1306_FONT_8x16_DERIVED)
     extern const uint8_t font_basic_8x16[];
     #if defined(_SSD1306_FONT_8x16_LOW)
         extern const uint8_t font_low_8x16[];
@@ -18,6 +18,9 @@
         extern const uint8_t font_high_8x16[];
     #endif
 #endif
+#if defined(_SSD1306_FONT_3x5)
+    extern const uint8_t font_mini_3x5[];
+#endif
 
 
 #if defined(_SSD1306_FONT_8x8)
@@ -2338,7 +2341,268 @@
     #endif
 #endif
 
-#if defined(_SSD1306_FONT_8x16)
+#if defined(_SSD1306_FONT_3x5)
+    const uint8_t font_mini_3x5[] = {  // 0x20-0x5F; 3 columns each
+              //     0x20
+        0x00, // ░░░░░░░░
+        0x00, // ░░░░░░░░
+        0x00, // ░░░░░░░░
+              // !   0x21
+        0x00, // ░░░░░░░░
+        0x5C, // ░█░███░░
+        0x00, // ░░░░░░░░
+              // "   0x22
+        0x0C, // ░░░░██░░
+        0x00, // ░░░░░░░░
+        0x0C, // ░░░░██░░
+              // #   0x23
+        0x7C, // ░█████░░
+        0x28, // ░░█░█░░░
+        0x7C, // ░█████░░
+              // $   0x24
+        0x48, // ░█░░█░░░
+        0x7C, // ░█████░░
+        0x24, // ░░█░░█░░
+              // %   0x25
+        0x64, // ░██░░█░░
+        0x10, // ░░░█░░░░
+        0x4C, // ░█░░██░░
+              // &   0x26
+        0x28, // ░░█░█░░░
+        0x54, // ░█░█░█░░
+        0x68, // ░██░█░░░
+              // '   0x27
+        0x00, // ░░░░░░░░
+        0x0C, // ░░░░██░░
+        0x00, // ░░░░░░░░
+              // (   0x28
+        0x00, // ░░░░░░░░
+        0x38, // ░░███░░░
+        0x44, // ░█░░░█░░
+              // )   0x29
+        0x44, // ░█░░░█░░
+        0x38, // ░░███░░░
+        0x00, // ░░░░░░░░
+              // *   0x2A
+        0x28, // ░░█░█░░░
+        0x10, // ░░░█░░░░
+        0x28, // ░░█░█░░░
+              // +   0x2B
+        0x10, // ░░░█░░░░
+        0x38, // ░░███░░░
+        0x10, // ░░░█░░░░
+              // ,   0x2C
+        0x40, // ░█░░░░░░
+        0x20, // ░░█░░░░░
+        0x00, // ░░░░░░░░
+              // -   0x2D
+        0x10, // ░░░█░░░░
+        0x10, // ░░░█░░░░
+        0x10, // ░░░█░░░░
+              // .   0x2E
+        0x00, // ░░░░░░░░
+        0x40, // ░█░░░░░░
+        0x00, // ░░░░░░░░
+              // /   0x2F
+        0x60, // ░██░░░░░
+        0x10, // ░░░█░░░░
+        0x0C, // ░░░░██░░
+              // 0   0x30
+        0x7C, // ░█████░░
+        0x44, // ░█░░░█░░
+        0x7C, // ░█████░░
+              // 1   0x31
+        0x48, // ░█░░█░░░
+        0x7C, // ░█████░░
+        0x40, // ░█░░░░░░
+              // 2   0x32
+        0x74, // ░███░█░░
+        0x54, // ░█░█░█░░
+        0x5C, // ░█░███░░
+              // 3   0x33
+        0x44, // ░█░░░█░░
+        0x54, // ░█░█░█░░
+        0x7C, // ░█████░░
+              // 4   0x34
+        0x1C, // ░░░███░░
+        0x10, // ░░░█░░░░
+        0x7C, // ░█████░░
+              // 5   0x35
+        0x5C, // ░█░███░░
+        0x54, // ░█░█░█░░
+        0x74, // ░███░█░░
+              // 6   0x36
+        0x7C, // ░█████░░
+        0x54, // ░█░█░█░░
+        0x74, // ░███░█░░
+              // 7   0x37
+        0x04, // ░░░░░█░░
+        0x64, // ░██░░█░░
+        0x1C, // ░░░███░░
+              // 8   0x38
+        0x7C, // ░█████░░
+        0x54, // ░█░█░█░░
+        0x7C, // ░█████░░
+              // 9   0x39
+        0x5C, // ░█░███░░
+        0x54, // ░█░█░█░░
+        0x7C, // ░█████░░
+              // :   0x3A
+        0x00, // ░░░░░░░░
+        0x28, // ░░█░█░░░
+        0x00, // ░░░░░░░░
+              // ;   0x3B
+        0x40, // ░█░░░░░░
+        0x28, // ░░█░█░░░
+        0x00, // ░░░░░░░░
+              // <   0x3C
+        0x10, // ░░░█░░░░
+        0x28, // ░░█░█░░░
+        0x44, // ░█░░░█░░
+              // =   0x3D
+        0x28, // ░░█░█░░░
+        0x28, // ░░█░█░░░
+        0x28, // ░░█░█░░░
+              // >   0x3E
+        0x44, // ░█░░░█░░
+        0x28, // ░░█░█░░░
+        0x10, // ░░░█░░░░
+              // ?   0x3F
+        0x04, // ░░░░░█░░
+        0x54, // ░█░█░█░░
+        0x1C, // ░░░███░░
+              // @   0x40
+        0x38, // ░░███░░░
+        0x54, // ░█░█░█░░
+        0x58, // ░█░██░░░
+              // A   0x41
+        0x78, // ░████░░░
+        0x14, // ░░░█░█░░
+        0x78, // ░████░░░
+              // B   0x42
+        0x7C, // ░█████░░
+        0x54, // ░█░█░█░░
+        0x28, // ░░█░█░░░
+              // C   0x43
+        0x38, // ░░███░░░
+        0x44, // ░█░░░█░░
+        0x44, // ░█░░░█░░
+              // D   0x44
+        0x7C, // ░█████░░
+        0x44, // ░█░░░█░░
+        0x38, // ░░███░░░
+              // E   0x45
+        0x7C, // ░█████░░
+        0x54, // ░█░█░█░░
+        0x44, // ░█░░░█░░
+              // F   0x46
+        0x7C, // ░█████░░
+        0x14, // ░░░█░█░░
+        0x04, // ░░░░░█░░
+              // G   0x47
+        0x38, // ░░███░░░
+        0x44, // ░█░░░█░░
+        0x74, // ░███░█░░
+              // H   0x48
+        0x7C, // ░█████░░
+        0x10, // ░░░█░░░░
+        0x7C, // ░█████░░
+              // I   0x49
+        0x44, // ░█░░░█░░
+        0x7C, // ░█████░░
+        0x44, // ░█░░░█░░
+              // J   0x4A
+        0x20, // ░░█░░░░░
+        0x40, // ░█░░░░░░
+        0x3C, // ░░████░░
+              // K   0x4B
+        0x7C, // ░█████░░
+        0x10, // ░░░█░░░░
+        0x6C, // ░██░██░░
+              // L   0x4C
+        0x7C, // ░█████░░
+        0x40, // ░█░░░░░░
+        0x40, // ░█░░░░░░
+              // M   0x4D
+        0x7C, // ░█████░░
+        0x18, // ░░░██░░░
+        0x7C, // ░█████░░
+              // N   0x4E
+        0x7C, // ░█████░░
+        0x04, // ░░░░░█░░
+        0x78, // ░████░░░
+              // O   0x4F
+        0x38, // ░░███░░░
+        0x44, // ░█░░░█░░
+        0x38, // ░░███░░░
+              // P   0x50
+        0x7C, // ░█████░░
+        0x14, // ░░░█░█░░
+        0x08, // ░░░░█░░░
+              // Q   0x51
+        0x38, // ░░███░░░
+        0x64, // ░██░░█░░
+        0x58, // ░█░██░░░
+              // R   0x52
+        0x7C, // ░█████░░
+        0x14, // ░░░█░█░░
+        0x68, // ░██░█░░░
+              // S   0x53
+        0x48, // ░█░░█░░░
+        0x54, // ░█░█░█░░
+        0x24, // ░░█░░█░░
+              // T   0x54
+        0x04, // ░░░░░█░░
+        0x7C, // ░█████░░
+        0x04, // ░░░░░█░░
+              // U   0x55
+        0x3C, // ░░████░░
+        0x40, // ░█░░░░░░
+        0x7C, // ░█████░░
+              // V   0x56
+        0x1C, // ░░░███░░
+        0x60, // ░██░░░░░
+        0x1C, // ░░░███░░
+              // W   0x57
+        0x7C, // ░█████░░
+        0x30, // ░░██░░░░
+        0x7C, // ░█████░░
+              // X   0x58
+        0x6C, // ░██░██░░
+        0x10, // ░░░█░░░░
+        0x6C, // ░██░██░░
+              // Y   0x59
+        0x0C, // ░░░░██░░
+        0x70, // ░███░░░░
+        0x0C, // ░░░░██░░
+              // Z   0x5A
+        0x64, // ░██░░█░░
+        0x54, // ░█░█░█░░
+        0x4C, // ░█░░██░░
+              // [   0x5B
+        0x7C, // ░█████░░
+        0x44, // ░█░░░█░░
+        0x00, // ░░░░░░░░
+              // \   0x5C
+        0x0C, // ░░░░██░░
+        0x10, // ░░░█░░░░
+        0x60, // ░██░░░░░
+              // ]   0x5D
+        0x00, // ░░░░░░░░
+        0x44, // ░█░░░█░░
+        0x7C, // ░█████░░
+              // ^   0x5E
+        0x08, // ░░░░█░░░
+        0x04, // ░░░░░█░░
+        0x08, // ░░░░█░░░
+              // _   0x5F
+        0x40, // ░█░░░░░░
+        0x40, // ░█░░░░░░
+        0x40, // ░█░░░░░░
+    };
+#endif
+
+#if defined(_SSD1306_FONT_8x16) && !defined(_SSD1306_FONT_8x16_DERIVED)
     const uint8_t font_basic_8x16[] = {
               //     0x20
         0x00, // ░░░░░░░░
@@ -0,0 +1,63 @@
+#include <xc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "stats.h"
+#include "system.h"
+
+uint16_t UsbServiceLast = 0;
+volatile uint16_t UsbServiceGapMax = 0;  // updated from interrupt when USB is interrupt-driven
+uint16_t I2CFailCount = 0;
+uint16_t RestoreCount = 0;
+uint16_t PartialRestoreCount = 0;
+
+
+void stats_usbServiced(void) {
+    uint16_t now = getTicks();
+    uint16_t gap = now - UsbServiceLast;
+    if (gap > UsbServiceGapMax) { UsbServiceGapMax = gap; }
+    UsbServiceLast = now;
+}
+
+uint16_t stats_getUsbGapMax(void) {
+    uint16_t gap;
+    do {  // read again if interrupt changed it in the middle
+        gap = UsbServiceGapMax;
+    } while (gap != UsbServiceGapMax);
+    return gap;
+}
+
+
+void stats_i2cFailed(const uint8_t count) {
+    uint16_t newCount = I2CFailCount + count;
+    I2CFailCount = (newCount >= I2CFailCount) ? newCount : 0xFFFF;  // saturate
+}
+
+uint16_t stats_getI2CFailCount(void) {
+    return I2CFailCount;
+}
+
+
+void stats_displayRestored(const bool partial) {
+    if (RestoreCount != 0xFFFF) { RestoreCount++; }  // saturate
+    if (partial && (PartialRestoreCount != 0xFFFF)) { PartialRestoreCount++; }
+}
+
+uint16_t stats_getRestoreCount(void) {
+    return RestoreCount;
+}
+
+uint16_t stats_getPartialRestoreCount(void) {
+    return PartialRestoreCount;
+}
+
+
+void stats_reset(void) {
+    bool hadInterruptsEnabled = (INTCONbits.GIE != 0);  // save if interrupts enabled
+    INTCONbits.GIE = 0;  // disable interrupts
+    UsbServiceLast = getTicks();
+    UsbServiceGapMax = 0;
+    I2CFailCount = 0;
+    RestoreCount = 0;
+    PartialRestoreCount = 0;
+    if (hadInterruptsEnabled) { INTCONbits.GIE = 1; }  // restore interrupts
+}
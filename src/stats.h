@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/** Records that USB stack was serviced. */
+void stats_usbServiced(void);
+
+/** Returns the longest time between two USB service calls (in ticks). */
+uint16_t stats_getUsbGapMax(void);
+
+
+/** Records failed I2C writes. */
+void stats_i2cFailed(const uint8_t count);
+
+/** Returns count of failed I2C writes. */
+uint16_t stats_getI2CFailCount(void);
+
+
+/** Records that selected display was redrawn after it came back; partial if some of its content was not recorded. */
+void stats_displayRestored(const bool partial);
+
+/** Returns count of display restores. */
+uint16_t stats_getRestoreCount(void);
+
+/** Returns count of display restores that could not redraw everything. */
+uint16_t stats_getPartialRestoreCount(void);
+
+
+/** Clears all collected statistics. */
+void stats_reset(void);
@@ -11,4 +11,18 @@ void init(void) {
     OSCCONbits.SPLLEN = 1;     // PLL is enabled
     ACTCONbits.ACTSRC = 1;     // The HFINTOSC oscillator is tuned using Fll-speed USB events
     ACTCONbits.ACTEN = 1;      // ACT is enabled, updates to OSCTUNE are exclusive to the ACT
+
+    // Timer1 (free-running tick counter)
+    T1CONbits.TMR1CS = 0b11;   // LFINTOSC (31 kHz) as clock source; synchronized to system clock
+    T1CONbits.T1CKPS = 0b00;   // 1:1 prescale
+    T1CONbits.TMR1ON = 1;      // Timer1 is enabled
+}
+
+uint16_t getTicks(void) {
+    uint8_t high, low;
+    do {  // read again if low byte overflowed in between
+        high = TMR1H;
+        low = TMR1L;
+    } while (high != TMR1H);
+    return (uint16_t)(high << 8) | low;
 }
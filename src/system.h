@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdint.h>
 #include "app.h"
 
 #define interruptsEnable()   GIE = 1
@@ -8,8 +9,13 @@
 #define reset()  asm("RESET");
 #define wait_short()  __delay_ms(150);
 
+#define TICKS_PER_MS  31  // LFINTOSC is about 32 us per tick
+
 void init(void);
 
+/** Returns free-running tick counter (LFINTOSC). */
+uint16_t getTicks(void);
+
 
 // CONFIG1
 #pragma config FOSC     = INTOSC    // INTOSC oscillator: I/O function on CLKIN pin
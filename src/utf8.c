@@ -0,0 +1,94 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "utf8.h"
+
+#define UTF8_MAP_COUNT  160
+
+const uint16_t Utf8MapCodePoints[UTF8_MAP_COUNT] = {  // sorted for binary search; box drawing, blocks, arrows, symbols, and accented letters
+    0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A5, 0x00A7, 0x00AA, 0x00AB, 0x00AC, 0x00B0, 0x00B1, 0x00B2,
+    0x00B5, 0x00B6, 0x00B7, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BF, 0x00C4, 0x00C5, 0x00C6, 0x00C7,
+    0x00C9, 0x00D1, 0x00D6, 0x00DC, 0x00DF, 0x00E0, 0x00E1, 0x00E2, 0x00E4, 0x00E5, 0x00E6, 0x00E7,
+    0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF, 0x00F1, 0x00F2, 0x00F3, 0x00F4,
+    0x00F6, 0x00F7, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FF, 0x0192, 0x0393, 0x0398, 0x03A3, 0x03A6,
+    0x03A9, 0x03B1, 0x03B4, 0x03B5, 0x03C0, 0x03C3, 0x03C4, 0x03C6, 0x2022, 0x203C, 0x207F, 0x20A7,
+    0x2190, 0x2191, 0x2192, 0x2193, 0x2194, 0x2195, 0x21A8, 0x2219, 0x221A, 0x221E, 0x221F, 0x2229,
+    0x2248, 0x2261, 0x2264, 0x2265, 0x2302, 0x2310, 0x2320, 0x2321, 0x2500, 0x2502, 0x250C, 0x2510,
+    0x2514, 0x2518, 0x251C, 0x2524, 0x252C, 0x2534, 0x253C, 0x2550, 0x2551, 0x2552, 0x2553, 0x2554,
+    0x2555, 0x2556, 0x2557, 0x2558, 0x2559, 0x255A, 0x255B, 0x255C, 0x255D, 0x255E, 0x255F, 0x2560,
+    0x2561, 0x2562, 0x2563, 0x2564, 0x2565, 0x2566, 0x2567, 0x2568, 0x2569, 0x256A, 0x256B, 0x256C,
+    0x2580, 0x2584, 0x2588, 0x258C, 0x2590, 0x2591, 0x2592, 0x2593, 0x25A0, 0x25AC, 0x25B2, 0x25BA,
+    0x25BC, 0x25C4, 0x25CB, 0x25D8, 0x25D9, 0x263A, 0x263B, 0x263C, 0x2640, 0x2642, 0x2660, 0x2663,
+    0x2665, 0x2666, 0x266A, 0x266B
+};
+
+const uint8_t Utf8MapCharacters[UTF8_MAP_COUNT] = {  // CP437 character for each code point above
+    0xFF, 0xAD, 0x9B, 0x9C, 0x9D, 0x15, 0xA6, 0xAE, 0xAA, 0xF8, 0xF1, 0xFD, 0xE6, 0x14, 0xFA, 0xA7,
+    0xAF, 0xAC, 0xAB, 0xA8, 0x8E, 0x8F, 0x92, 0x80, 0x90, 0xA5, 0x99, 0x9A, 0xE1, 0x85, 0xA0, 0x83,
+    0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B, 0xA4, 0x95, 0xA2, 0x93,
+    0x94, 0xF6, 0x97, 0xA3, 0x96, 0x81, 0x98, 0x9F, 0xE2, 0xE9, 0xE4, 0xE8, 0xEA, 0xE0, 0xEB, 0xEE,
+    0xE3, 0xE5, 0xE7, 0xED, 0x07, 0x13, 0xFC, 0x9E, 0x1B, 0x18, 0x1A, 0x19, 0x1D, 0x12, 0x17, 0xF9,
+    0xFB, 0xEC, 0x1C, 0xEF, 0xF7, 0xF0, 0xF3, 0xF2, 0x7F, 0xA9, 0xF4, 0xF5, 0xC4, 0xB3, 0xDA, 0xBF,
+    0xC0, 0xD9, 0xC3, 0xB4, 0xC2, 0xC1, 0xC5, 0xCD, 0xBA, 0xD5, 0xD6, 0xC9, 0xB8, 0xB7, 0xBB, 0xD4,
+    0xD3, 0xC8, 0xBE, 0xBD, 0xBC, 0xC6, 0xC7, 0xCC, 0xB5, 0xB6, 0xB9, 0xD1, 0xD2, 0xCB, 0xCF, 0xD0,
+    0xCA, 0xD8, 0xD7, 0xCE, 0xDF, 0xDC, 0xDB, 0xDD, 0xDE, 0xB0, 0xB1, 0xB2, 0xFE, 0x16, 0x1E, 0x10,
+    0x1F, 0x11, 0x09, 0x08, 0x0A, 0x01, 0x02, 0x0F, 0x0C, 0x0B, 0x06, 0x05, 0x03, 0x04, 0x0D, 0x0E
+};
+
+uint16_t Utf8CodePoint;
+uint8_t Utf8Remaining = 0;  // continuation bytes still expected
+bool Utf8IsWide;  // 4-byte sequence; nothing there has CP437 character
+
+
+void utf8_reset(void) {
+    Utf8Remaining = 0;
+}
+
+bool utf8_decode(const uint8_t value, uint16_t* codePoint) {
+    if (value < 0x80) {  // ASCII interrupts any sequence
+        Utf8Remaining = 0;
+        *codePoint = value;
+        return true;
+    }
+
+    if ((value & 0xC0) == 0x80) {  // continuation
+        if (Utf8Remaining == 0) { return false; }  // stray byte is ignored
+        Utf8CodePoint = (uint16_t)((Utf8CodePoint << 6) | (value & 0x3F));
+        Utf8Remaining--;
+        if (Utf8Remaining != 0) { return false; }
+        *codePoint = Utf8IsWide ? 0xFFFF : Utf8CodePoint;
+        return true;
+    }
+
+    if ((value & 0xE0) == 0xC0) {
+        Utf8CodePoint = value & 0x1F;
+        Utf8Remaining = 1;
+    } else if ((value & 0xF0) == 0xE0) {
+        Utf8CodePoint = value & 0x0F;
+        Utf8Remaining = 2;
+    } else if ((value & 0xF8) == 0xF0) {
+        Utf8CodePoint = 0;
+        Utf8Remaining = 3;
+    } else {  // invalid lead byte is ignored
+        Utf8Remaining = 0;
+    }
+    Utf8IsWide = (Utf8Remaining == 3);
+    return false;
+}
+
+uint8_t utf8_toCp437(const uint16_t codePoint) {
+    if (codePoint < 0x7F) { return (uint8_t)codePoint; }  // ASCII is the same
+
+    uint8_t low = 0;
+    uint8_t high = UTF8_MAP_COUNT;
+    while (low < high) {
+        uint8_t middle = (uint8_t)((low + high) >> 1);
+        uint16_t value = Utf8MapCodePoints[middle];
+        if (value == codePoint) { return Utf8MapCharacters[middle]; }
+        if (value < codePoint) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return '?';
+}
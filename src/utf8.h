@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/** Forgets partially decoded sequence. */
+void utf8_reset(void);
+
+/** Feeds a single byte; returns true once code point is complete. Code points above 0xFFFF are returned as 0xFFFF. */
+bool utf8_decode(const uint8_t value, uint16_t* codePoint);
+
+/** Returns CP437 character for given code point; '?' if there is none. */
+uint8_t utf8_toCp437(const uint16_t codePoint);
@@ -0,0 +1,33 @@
+/* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+
+/**
+ * Host replacement for XC8's <xc.h>; just enough for the firmware's protocol
+ * core to compile and run on Linux.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define __at(address)
+#define __interrupt()
+#define __delay_ms(x)
+#define __delay_us(x)
+
+void host_asm(const char* instruction);
+#define asm(instruction)  host_asm(instruction)
+
+
+// registers touched by settings.c
+
+typedef struct { uint8_t GIE; } host_INTCONbits_t;
+extern host_INTCONbits_t INTCONbits;
+
+typedef struct { uint8_t WREN, CFGS, FREE, WR, LWLO; } host_PMCON1bits_t;
+extern host_PMCON1bits_t PMCON1bits;
+
+extern uint8_t PMCON2;
+extern uint16_t PMADR;
+extern uint8_t PMDATH;
+extern uint8_t PMDATL;
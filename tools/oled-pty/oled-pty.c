@@ -0,0 +1,409 @@
+/* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+
+/**
+ * Virtual UsbOled behind a pseudo-terminal
+ *
+ * Runs the firmware's protocol core (protocol.c, ssd1306.c, settings.c, and
+ * buffer.c - compiled unmodified) against an SSD1306 model connected over I2C
+ * or SPI. Host data is fed in CDC_DATA_OUT_EP_SIZE packets through the OUT
+ * endpoint buffers (two when ping-pong buffered) using the same loop order as
+ * main() and each I2C transaction is charged for its bus time. Responses are
+ * held back until the modeled time has passed so the host sees realistic
+ * latency.
+ *
+ * On exit (or SIGUSR1) per-line latency percentiles and frame rate are
+ * reported. A frame starts with each BEL or BS character received. SIGUSR2
+ * disconnects the panel and reconnects it (blank and uninitialized) on the
+ * next one.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <xc.h>
+
+#include "../../src/Microchip/usb_common.h"
+#include "../../src/buffer.c"
+#include "../../src/marquee.c"
+#include "../../src/protocol.c"
+#include "../../src/screen.c"
+#include "../../src/settings.c"
+#include "../../src/ssd1306.c"
+#include "../../src/stats.c"
+#include "../../src/utf8.c"
+
+#include "ssd1306_model.h"
+
+
+host_INTCONbits_t INTCONbits;
+host_PMCON1bits_t PMCON1bits;
+uint8_t PMCON2;
+uint16_t PMADR;
+uint8_t PMDATH;
+uint8_t PMDATL;
+
+bool ResetRequested = false;
+
+uint64_t DeviceTime;  // modeled device time (in ns)
+uint64_t DeviceBusTime;  // I2C bus time already included in device time
+
+uint16_t getTicks(void) {  // same rate as Timer1 running from LFINTOSC
+    return (uint16_t)((DeviceTime + model_getBusTime() - DeviceBusTime) / (1000000 / TICKS_PER_MS));
+}
+
+void host_asm(const char* instruction) {
+    if (strcmp(instruction, "RESET") == 0) { ResetRequested = true; }
+}
+
+
+volatile sig_atomic_t Running = 1;
+volatile sig_atomic_t ReportRequested = 0;
+volatile sig_atomic_t PlugRequested = 0;
+
+void onSignal(int signal) {
+    if (signal == SIGUSR1) {
+        ReportRequested = 1;
+    } else if (signal == SIGUSR2) {
+        PlugRequested = 1;
+    } else {
+        Running = 0;
+    }
+}
+
+
+uint64_t now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void sleepUntil(const uint64_t time) {
+    struct timespec ts = { .tv_sec = (time_t)(time / 1000000000), .tv_nsec = (long)(time % 1000000000) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) { }
+}
+
+
+#define RX_QUEUE_MAX  65536
+uint8_t RxQueue[RX_QUEUE_MAX];
+size_t RxQueueStart, RxQueueCount, RxQueueLineCount;
+
+#define PENDING_MAX  4096
+uint64_t PendingLines[PENDING_MAX];  // arrival time of each line ending not yet acknowledged
+size_t PendingStart, PendingCount;
+
+uint32_t* Latencies;  // in us
+size_t LatencyCount, LatencyCapacity;
+
+#if (USB_PING_PONG_MODE == USB_PING_PONG__FULL_PING_PONG) || (USB_PING_PONG_MODE == USB_PING_PONG__ALL_BUT_EP0)
+    #define ENDPOINT_BUFFERS  2  // same as CDC_DATA_OUT_BUFFERS
+#else
+    #define ENDPOINT_BUFFERS  1
+#endif
+uint8_t EndpointPacket[ENDPOINT_BUFFERS][CDC_DATA_OUT_EP_SIZE];  // OUT packets received but not yet read
+uint8_t EndpointLength[ENDPOINT_BUFFERS];
+unsigned EndpointStart, EndpointCount;
+
+uint64_t FrameCount, FrameFirst, FrameLast;
+uint64_t UsbInBytes, UsbInPackets, UsbInNaks, UsbOutBytes, UsbOutPackets;
+uint64_t DsrDropCount;
+bool DsrState = true;
+uint64_t OverflowCount, LostLineCount;
+
+
+void recordLatency(const uint64_t latencyNs) {
+    if (LatencyCount == LatencyCapacity) {
+        LatencyCapacity = LatencyCapacity ? LatencyCapacity * 2 : 4096;
+        Latencies = realloc(Latencies, LatencyCapacity * sizeof(uint32_t));
+        if (Latencies == NULL) { perror("realloc"); exit(1); }
+    }
+    Latencies[LatencyCount++] = (uint32_t)(latencyNs / 1000);
+}
+
+int compareLatency(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t percentile(const uint32_t* sorted, const size_t count, const unsigned percent) {
+    if (count == 0) { return 0; }
+    size_t index = (count * percent + 99) / 100;
+    return sorted[(index > 0) ? index - 1 : 0];
+}
+
+void report(FILE* output) {
+    uint32_t* sorted = malloc((LatencyCount ? LatencyCount : 1) * sizeof(uint32_t));
+    if (sorted == NULL) { perror("malloc"); exit(1); }
+    memcpy(sorted, Latencies, LatencyCount * sizeof(uint32_t));
+    qsort(sorted, LatencyCount, sizeof(uint32_t), compareLatency);
+
+    double fps = 0;
+    if ((FrameCount > 1) && (FrameLast > FrameFirst)) {
+        fps = (double)(FrameCount - 1) * 1e9 / (double)(FrameLast - FrameFirst);
+    }
+
+    fprintf(output, "lines:   %zu (lost %llu, overflows %llu)\n", LatencyCount, (unsigned long long)LostLineCount, (unsigned long long)OverflowCount);
+    fprintf(output, "latency: p50 %u us, p90 %u us, p99 %u us, max %u us\n",
+            percentile(sorted, LatencyCount, 50), percentile(sorted, LatencyCount, 90),
+            percentile(sorted, LatencyCount, 99), LatencyCount ? sorted[LatencyCount - 1] : 0);
+    fprintf(output, "frames:  %llu (%.2f fps)\n", (unsigned long long)FrameCount, fps);
+    fprintf(output, "usb:     OUT %llu bytes in %llu packets (%llu passes NAKed), IN %llu bytes in %llu packets\n",
+            (unsigned long long)UsbInBytes, (unsigned long long)UsbInPackets, (unsigned long long)UsbInNaks,
+            (unsigned long long)UsbOutBytes, (unsigned long long)UsbOutPackets);
+    fprintf(output, "dsr:     dropped %llu times\n", (unsigned long long)DsrDropCount);
+    fprintf(output, "usb gap: max %u us between service calls\n", (unsigned)stats_getUsbGapMax() * 1000 / TICKS_PER_MS);
+    fprintf(output, "arena:   %u bytes (input %u, output %u, draw %u, %u free blocks of %u)\n", BUFFER_ARENA_SIZE,
+            INPUT_BUFFER_MAX, OUTPUT_BUFFER_MAX, DRAW_QUEUE_MAX, buffer_getFreeBlocks(), BUFFER_BLOCK_SIZE);
+    fprintf(output, "%s:     %llu bytes, %.3f ms busy at %u kHz (%u failed writes)\n", model_isSpi() ? "spi" : "i2c", (unsigned long long)model_getBusBytes(),
+            (double)model_getBusTime() / 1e6, model_getBusClock() / 1000, stats_getI2CFailCount());
+    fflush(output);
+    free(sorted);
+}
+
+
+void usage(const char* name) {
+    fprintf(stderr, "Usage: %s [options]\n", name);
+    fprintf(stderr, "  -l <path>  create symlink to the pseudo-terminal\n");
+    fprintf(stderr, "  -a <hex>   panel I2C address (default 3C)\n");
+    fprintf(stderr, "  -H <n>     display height: 32, 64, or 128 (default from settings)\n");
+    fprintf(stderr, "  -s <n>     I2C speed index: 1-9 or 0 for 1 MHz (default from settings)\n");
+    fprintf(stderr, "  -x <kHz>   fastest I2C clock panel acknowledges (default any)\n");
+    fprintf(stderr, "  -S         connect panel over SPI (speed index is in MHz)\n");
+    fprintf(stderr, "  -r <path>  record every bus transaction to file\n");
+    fprintf(stderr, "  -u <us>    USB time per %d-byte packet (default 50)\n", CDC_DATA_OUT_EP_SIZE);
+    fprintf(stderr, "  -o <ns>    firmware overhead per I2C byte (default 1000)\n");
+    fprintf(stderr, "  -t <s>     exit after given seconds without input\n");
+    fprintf(stderr, "  -n         do not delay responses (report modeled time only)\n");
+    fprintf(stderr, "  -d         dump display content on exit\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* linkPath = NULL;
+    uint8_t panelAddress = 0;
+    uint8_t height = 0;
+    int speedIndex = -1;
+    uint32_t clockLimit = 0;
+    bool useSpi = false;
+    const char* recordPath = NULL;
+    uint64_t usbPacketNs = 50000;
+    uint32_t byteOverheadNs = 1000;
+    uint64_t idleTimeoutNs = 0;
+    bool realTime = true;
+    bool dump = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "l:a:H:s:x:Sr:u:o:t:ndh")) != -1) {
+        switch (option) {
+            case 'l': linkPath = optarg; break;
+            case 'a': panelAddress = (uint8_t)strtoul(optarg, NULL, 16); break;
+            case 'H': height = (uint8_t)atoi(optarg); break;
+            case 's': speedIndex = atoi(optarg); break;
+            case 'x': clockLimit = (uint32_t)strtoul(optarg, NULL, 10) * 1000; break;
+            case 'S': useSpi = true; break;
+            case 'r': recordPath = optarg; break;
+            case 'u': usbPacketNs = strtoull(optarg, NULL, 10) * 1000; break;
+            case 'o': byteOverheadNs = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 't': idleTimeoutNs = strtoull(optarg, NULL, 10) * 1000000000; break;
+            case 'n': realTime = false; break;
+            case 'd': dump = true; break;
+            default: usage(argv[0]); return (option == 'h') ? 0 : 2;
+        }
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) { perror("posix_openpt"); return 1; }
+    const char* slaveName = ptsname(master);
+    int slave = open(slaveName, O_RDWR | O_NOCTTY);  // kept open so host can reconnect without EIO
+    if (slave < 0) { perror("open"); return 1; }
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    if (linkPath != NULL) {
+        unlink(linkPath);
+        if (symlink(slaveName, linkPath) != 0) { perror("symlink"); return 1; }
+    }
+    printf("%s\n", slaveName);
+    fflush(stdout);
+
+    struct sigaction action = { .sa_handler = onSignal };
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGUSR1, &action, NULL);
+    sigaction(SIGUSR2, &action, NULL);
+
+    settings_init();
+    if (panelAddress != 0) { settings_setI2CAddress(0, panelAddress); }
+    if (height != 0) { settings_setDisplayHeight(0, height); }
+    if (speedIndex >= 0) { settings_setI2CSpeedIndex((speedIndex == 0) ? 10 : (uint8_t)speedIndex); }
+    if (useSpi) { settings_setUseSpi(true); }
+    model_init(SETTING_DEFAULT_I2C_ADDRESS, byteOverheadNs);
+    if (panelAddress != 0) { model_init(panelAddress, byteOverheadNs); }
+    model_setClockLimit(clockLimit);
+    FILE* record = NULL;
+    if (recordPath != NULL) {
+        record = fopen(recordPath, "w");
+        if (record == NULL) { perror("fopen"); return 1; }
+        model_setLog(record);
+    }
+    protocol_init();
+
+    DeviceTime = now();
+    DeviceBusTime = model_getBusTime();
+    uint64_t lastInput = DeviceTime;
+    stats_reset();
+
+    while (Running) {
+        if (ReportRequested) { ReportRequested = 0; report(stderr); }
+        if (PlugRequested) { PlugRequested = 0; model_setConnected(!model_isConnected()); }
+
+        bool busy = (RxQueueCount > 0) || (EndpointCount > 0) || (OutputBufferCount() > 0) || (InputLineEnd > 0) || LineActive || !protocol_isRendered() || ResetRequested;
+        struct pollfd pfd = { .fd = master, .events = POLLIN };
+        int pollTimeout = busy ? 0 : 1;  // background work (e.g. marquee) expects main loop to come around often
+        if (poll(&pfd, 1, pollTimeout) > 0) {
+            if (pfd.revents & POLLIN) {
+                uint8_t buffer[4096];
+                size_t space = RX_QUEUE_MAX - RxQueueCount;
+                ssize_t n = read(master, buffer, (space < sizeof(buffer)) ? space : sizeof(buffer));
+                uint64_t arrival = now();
+                for (ssize_t i = 0; i < n; i++) {
+                    RxQueue[(RxQueueStart + RxQueueCount) % RX_QUEUE_MAX] = buffer[i];
+                    RxQueueCount++;
+                    if ((buffer[i] == 0x0A) || (buffer[i] == 0x0D)) {
+                        RxQueueLineCount++;
+                        if (PendingCount < PENDING_MAX) {
+                            PendingLines[(PendingStart + PendingCount) % PENDING_MAX] = arrival;
+                            PendingCount++;
+                        }
+                    }
+                }
+                if (n > 0) { lastInput = arrival; }
+            }
+        }
+
+        if (!busy && (RxQueueCount == 0)) {
+            if ((idleTimeoutNs > 0) && (now() - lastInput > idleTimeoutNs)) { break; }
+            DeviceTime = now(); DeviceBusTime = model_getBusTime(); UsbServiceLast = getTicks();
+            protocol_process();  // background work (e.g. display probing) runs even without input
+            DeviceBusTime = model_getBusTime();
+            continue;
+        }
+
+        uint64_t realNow = now();
+        if (DeviceTime < realNow) { DeviceTime = realNow; UsbServiceLast = getTicks(); }  // device was idle; it would have serviced USB all along
+        stats_usbServiced();
+
+        if (ResetRequested) {  // what would happen after reboot
+            ResetRequested = false;
+            InputBufferCount = 0; InputBufferCorrupted = false; OutputBufferHead = 0; OutputBufferTail = 0;
+            EndpointCount = 0;
+            LostLineCount += PendingCount; PendingCount = 0;
+            settings_init();
+            protocol_init();
+        }
+
+        // USB receive - host fills every armed OUT buffer; anything more is NAKed
+        while ((RxQueueCount > 0) && (EndpointCount < ENDPOINT_BUFFERS)) {
+            uint8_t* packet = EndpointPacket[(EndpointStart + EndpointCount) % ENDPOINT_BUFFERS];
+            uint8_t packetCount = 0;
+            while ((RxQueueCount > 0) && (packetCount < CDC_DATA_OUT_EP_SIZE)) {
+                uint8_t value = RxQueue[RxQueueStart];
+                RxQueueStart = (RxQueueStart + 1) % RX_QUEUE_MAX;
+                RxQueueCount--;
+                packet[packetCount++] = value;
+                if ((value == 0x0A) || (value == 0x0D)) { RxQueueLineCount--; }
+                if ((value == 0x07) || (value == 0x08)) {
+                    if (FrameCount == 0) { FrameFirst = DeviceTime; }
+                    FrameLast = DeviceTime;
+                    FrameCount++;
+                }
+            }
+            EndpointLength[(EndpointStart + EndpointCount) % ENDPOINT_BUFFERS] = packetCount;
+            EndpointCount++;
+            DeviceTime += usbPacketNs;
+            UsbInBytes += packetCount; UsbInPackets++;
+        }
+        if (RxQueueCount > 0) { UsbInNaks++; }
+
+        bool dsr = protocol_isInputReady();  // serial state notification
+        if (DsrState && !dsr) { DsrDropCount++; }
+        DsrState = dsr;
+
+        if ((EndpointCount > 0) && protocol_canReceive()) {  // parsed in place; same as peekUSBUSART()
+            if (!protocol_receive(EndpointPacket[EndpointStart], EndpointLength[EndpointStart])) { OverflowCount++; }
+            EndpointStart = (EndpointStart + 1) % ENDPOINT_BUFFERS;  // releaseUSBUSART()
+            EndpointCount--;
+        }
+
+        // USB send
+        if (OutputBufferCount() > 0) {
+            uint8_t start = OutputBufferTail & (OUTPUT_BUFFER_MAX - 1);  // same span as usbService()
+            uint8_t writeCount = OUTPUT_BUFFER_MAX - start;
+            if (writeCount > OutputBufferCount()) { writeCount = OutputBufferCount(); }
+            if (writeCount > CDC_DATA_IN_EP_SIZE) { writeCount = CDC_DATA_IN_EP_SIZE; }
+            const uint8_t* packet = &OutputBuffer[start];
+            DeviceTime += usbPacketNs;
+            if (realTime) { sleepUntil(DeviceTime); }
+            for (uint8_t i = 0; i < writeCount; i++) {
+                uint8_t value = packet[i];
+                if (((value == 0x0A) || (value == 0x0D)) && (PendingCount > 0)) {
+                    recordLatency(DeviceTime - PendingLines[PendingStart]);
+                    PendingStart = (PendingStart + 1) % PENDING_MAX;
+                    PendingCount--;
+                }
+            }
+            for (uint8_t i = 0; i < writeCount; ) {
+                ssize_t n = write(master, &packet[i], writeCount - i);
+                if (n <= 0) { if (errno == EINTR) { continue; } perror("write"); break; }
+                i += (uint8_t)n;
+            }
+            UsbOutBytes += writeCount; UsbOutPackets++;
+            OutputBufferTail += writeCount;
+        }
+
+        // Process line
+        protocol_process();
+        uint64_t busTime = model_getBusTime();
+        DeviceTime += busTime - DeviceBusTime;
+        DeviceBusTime = busTime;
+
+        size_t waitingCount = RxQueueLineCount;  // line endings that can still be acknowledged
+        for (unsigned e = 0; e < EndpointCount; e++) {
+            unsigned index = (EndpointStart + e) % ENDPOINT_BUFFERS;
+            for (uint8_t i = 0; i < EndpointLength[index]; i++) {
+                if ((EndpointPacket[index][i] == 0x0A) || (EndpointPacket[index][i] == 0x0D)) { waitingCount++; }
+            }
+        }
+        for (uint8_t i = 0; i < InputBufferCount; i++) {
+            if ((InputBuffer[i] == 0x0A) || (InputBuffer[i] == 0x0D)) { waitingCount++; }
+        }
+        for (uint8_t i = 0; i < OutputBufferCount(); i++) {
+            uint8_t value = OutputBuffer[(uint8_t)(OutputBufferTail + i) & (OUTPUT_BUFFER_MAX - 1)];
+            if ((value == 0x0A) || (value == 0x0D)) { waitingCount++; }
+        }
+        while (PendingCount > waitingCount) {  // dropped together with an overflowing line
+            PendingStart = (PendingStart + 1) % PENDING_MAX;
+            PendingCount--;
+            LostLineCount++;
+        }
+    }
+
+    report(stdout);
+    if (dump) { model_dump(stdout, settings_getDisplayHeight(0)); }
+    if (record != NULL) { model_setLog(NULL); fclose(record); }
+
+    if (linkPath != NULL) { unlink(linkPath); }
+    close(slave);
+    close(master);
+    return 0;
+}
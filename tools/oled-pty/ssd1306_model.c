@@ -0,0 +1,295 @@
+/* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "i2c_master.h"
+#include "spi_master.h"
+#include "ssd1306_model.h"
+
+#define MODEL_COLUMNS  128
+#define MODEL_PAGES    16
+
+uint8_t modelAddress;
+uint32_t modelByteOverheadNs;
+uint32_t modelClock = 100000;
+uint32_t modelClockLimit;  // fastest clock panel acknowledges at; 0 if any
+bool modelConnected = true;
+uint64_t modelBusTime;
+uint64_t modelBusBytes;
+bool modelSpi;  // last initialized transport
+FILE* modelLog;
+
+uint8_t modelRam[MODEL_PAGES][MODEL_COLUMNS];
+uint8_t modelMode = 0b10;  // page addressing
+uint8_t modelPage;
+uint8_t modelColumn;
+uint8_t modelColumnStart, modelColumnEnd = MODEL_COLUMNS - 1;
+uint8_t modelPageStart, modelPageEnd = MODEL_PAGES - 1;
+bool modelDisplayOn;
+bool modelInverse;
+bool modelZoom;
+
+uint8_t modelCommand[8];  // current command and its parameters
+uint8_t modelCommandCount;
+
+
+void model_init(const uint8_t address, const uint32_t byteOverheadNs) {
+    modelAddress = address;
+    modelByteOverheadNs = byteOverheadNs;
+}
+
+void model_setLog(FILE* log) {
+    modelLog = log;
+}
+
+void model_setClockLimit(const uint32_t clockLimit) {
+    modelClockLimit = clockLimit;
+}
+
+void model_setConnected(const bool connected) {
+    if (connected && !modelConnected) {  // power-up state
+        memset(modelRam, 0, sizeof(modelRam));
+        modelMode = 0b10;
+        modelPage = 0; modelColumn = 0;
+        modelColumnStart = 0; modelColumnEnd = MODEL_COLUMNS - 1;
+        modelPageStart = 0; modelPageEnd = MODEL_PAGES - 1;
+        modelDisplayOn = false;
+        modelInverse = false;
+        modelZoom = false;
+    }
+    modelConnected = connected;
+}
+
+bool model_isConnected(void) {
+    return modelConnected;
+}
+
+bool model_isResponding(const uint8_t deviceAddress) {
+    if (!modelConnected) { return false; }
+    if (modelSpi) { return ((deviceAddress ^ modelAddress) & 0x01) == 0; }  // lowest bit selects chip select line
+    if (deviceAddress != modelAddress) { return false; }
+    return (modelClockLimit == 0) || (modelClock <= modelClockLimit);
+}
+
+uint64_t model_getBusTime(void) {
+    return modelBusTime;
+}
+
+uint64_t model_getBusBytes(void) {
+    return modelBusBytes;
+}
+
+uint32_t model_getBusClock(void) {
+    return modelClock;
+}
+
+bool model_isSpi(void) {
+    return modelSpi;
+}
+
+void model_dump(FILE* output, const uint8_t height) {
+    fprintf(output, "+");
+    for (uint8_t x = 0; x < MODEL_COLUMNS; x++) { fprintf(output, "-"); }
+    fprintf(output, "+\n");
+    for (uint8_t y = 0; y < height; y += 2) {  // two pixel rows per text line
+        fprintf(output, "|");
+        uint8_t upperLine = modelZoom ? (y >> 1) : y;  // zoom shows each line twice
+        uint8_t lowerLine = modelZoom ? (y >> 1) : y + 1;
+        for (uint8_t x = 0; x < MODEL_COLUMNS; x++) {
+            bool upper = (modelRam[upperLine >> 3][x] >> (upperLine & 0x07)) & 0x01;
+            bool lower = (modelRam[lowerLine >> 3][x] >> (lowerLine & 0x07)) & 0x01;
+            if (modelInverse) { upper = !upper; lower = !lower; }
+            fprintf(output, "%s", upper ? (lower ? "█" : "▀") : (lower ? "▄" : " "));
+        }
+        fprintf(output, "|\n");
+    }
+    fprintf(output, "+");
+    for (uint8_t x = 0; x < MODEL_COLUMNS; x++) { fprintf(output, "-"); }
+    fprintf(output, "+\n");
+}
+
+
+uint8_t model_getParameterCount(const uint8_t command) {
+    switch (command) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD6: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27: case 0x2C: case 0x2D:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+void model_executeCommand(void) {
+    uint8_t command = modelCommand[0];
+    if (command <= 0x0F) {  // lower column start address
+        modelColumn = (modelColumn & 0xF0) | (command & 0x0F);
+    } else if (command <= 0x1F) {  // upper column start address
+        modelColumn = (uint8_t)(((command & 0x07) << 4) | (modelColumn & 0x0F));
+    } else if ((command >= 0xB0) && (command <= 0xBF)) {  // page start address
+        modelPage = command & 0x0F;
+    } else {
+        switch (command) {
+            case 0x20: modelMode = modelCommand[1] & 0x03; break;
+            case 0x21:
+                modelColumnStart = modelCommand[1] & 0x7F;
+                modelColumnEnd = modelCommand[2] & 0x7F;
+                modelColumn = modelColumnStart;
+                break;
+            case 0x22:
+                modelPageStart = modelCommand[1] & 0x0F;
+                modelPageEnd = modelCommand[2] & 0x0F;
+                modelPage = modelPageStart;
+                break;
+            case 0x2C: case 0x2D: {  // content scroll by one column; column pushed out comes back on the other side
+                uint8_t columnStart = modelCommand[5] & 0x7F;
+                uint8_t columnEnd = modelCommand[6] & 0x7F;
+                if (columnStart >= columnEnd) { break; }
+                for (uint8_t page = modelCommand[2] & 0x07; page <= (modelCommand[4] & 0x07); page++) {
+                    uint8_t* ram = &modelRam[page][columnStart];
+                    size_t count = columnEnd - columnStart;
+                    if (command == 0x2D) {  // left
+                        uint8_t first = ram[0];
+                        memmove(ram, ram + 1, count);
+                        ram[count] = first;
+                    } else {
+                        uint8_t last = ram[count];
+                        memmove(ram + 1, ram, count);
+                        ram[0] = last;
+                    }
+                }
+            } break;
+            case 0xA6: modelInverse = false; break;
+            case 0xA7: modelInverse = true; break;
+            case 0xAE: modelDisplayOn = false; break;
+            case 0xAF: modelDisplayOn = true; break;
+            case 0xD6: modelZoom = modelCommand[1] & 0x01; break;
+            default: break;  // everything else has no effect on memory content
+        }
+    }
+}
+
+void model_writeCommandByte(const uint8_t value) {
+    modelCommand[modelCommandCount] = value;
+    modelCommandCount++;
+    if (modelCommandCount > model_getParameterCount(modelCommand[0])) {
+        model_executeCommand();
+        modelCommandCount = 0;
+    }
+}
+
+void model_writeDataByte(const uint8_t value) {
+    modelRam[modelPage & 0x0F][modelColumn & 0x7F] = value;
+    switch (modelMode) {
+        case 0b00:  // horizontal
+            if (modelColumn >= modelColumnEnd) {
+                modelColumn = modelColumnStart;
+                modelPage = (modelPage >= modelPageEnd) ? modelPageStart : modelPage + 1;
+            } else {
+                modelColumn++;
+            }
+            break;
+
+        case 0b01:  // vertical
+            if (modelPage >= modelPageEnd) {
+                modelPage = modelPageStart;
+                modelColumn = (modelColumn >= modelColumnEnd) ? modelColumnStart : modelColumn + 1;
+            } else {
+                modelPage++;
+            }
+            break;
+
+        default:  // page
+            modelColumn = (modelColumn + 1) & 0x7F;
+            break;
+    }
+}
+
+void model_chargeBus(const uint16_t byteCount) {
+    uint64_t clocks = modelSpi ? (uint64_t)byteCount * 8 : (uint64_t)byteCount * 9 + 2;  // SPI has no ACK, start, or stop
+    modelBusTime += clocks * 1000000000 / modelClock + (uint64_t)byteCount * modelByteOverheadNs;
+    modelBusBytes += byteCount;
+}
+
+void model_log(const uint8_t deviceAddress, const uint8_t control, const uint8_t* data, const uint8_t count, const bool wasOk) {
+    if (modelLog == NULL) { return; }
+    fprintf(modelLog, "%s %02X %c", modelSpi ? "spi" : "i2c", deviceAddress, (control & 0x40) ? 'D' : 'C');
+    for (uint8_t i = 0; i < count; i++) { fprintf(modelLog, " %02X", (data != NULL) ? data[i] : 0); }
+    fprintf(modelLog, "%s\n", wasOk ? "" : " NAK");
+}
+
+bool model_transfer(const uint8_t deviceAddress, const uint8_t control, const uint8_t* data, const uint8_t count) {
+    if (!model_isResponding(deviceAddress)) {  // nobody there or too fast; address byte is NAKed
+        model_chargeBus(modelSpi ? count : 1);
+        model_log(deviceAddress, control, data, count, modelSpi);  // SPI never knows
+        return modelSpi;
+    }
+    model_chargeBus(modelSpi ? count : (uint16_t)count + 2);
+    model_log(deviceAddress, control, data, count, true);
+
+    modelCommandCount = 0;  // commands never span transactions
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t value = (data != NULL) ? data[i] : 0;
+        if (control & 0x40) {
+            model_writeDataByte(value);
+        } else {
+            model_writeCommandByte(value);
+        }
+    }
+    return true;
+}
+
+
+void spi_master_init(const uint8_t rate) {  // same calculation as firmware
+    uint8_t divider = (uint8_t)((_XTAL_FREQ / 4 / 1000000 + rate - 1) / rate);
+    if (divider == 0) { divider = 1; }
+    modelClock = _XTAL_FREQ / 4 / divider;
+    modelSpi = true;
+}
+
+bool spi_master_writeBytes(const uint8_t device, const bool isData, const uint8_t* data, const uint8_t count) {
+    return model_transfer(device, isData ? 0x40 : 0x00, data, count);
+}
+
+void i2c_master_init(uint8_t rate) {  // same calculation as firmware
+    uint8_t baudRateCounter;
+    if (rate < 10) {
+        baudRateCounter = _XTAL_FREQ / 4 / 100000 - 1;
+    } else if (rate > 100) {
+        baudRateCounter = _XTAL_FREQ / 4 / 1000000 - 1;
+    } else {
+        baudRateCounter = (uint8_t)((uint32_t)_XTAL_FREQ / 4 / 10000 / rate - 1);
+    }
+    modelClock = _XTAL_FREQ / 4 / (baudRateCounter + 1);
+    modelSpi = false;
+}
+
+bool i2c_master_readRegisterBytes(const uint8_t deviceAddress, const uint8_t registerAddress, uint8_t* readData, const uint8_t readCount) {
+    (void)registerAddress;
+    memset(readData, 0, readCount);
+    if (!model_isResponding(deviceAddress)) { model_chargeBus(1); return false; }
+    model_chargeBus((uint16_t)readCount + 3);  // address, register, repeated start address
+    return true;
+}
+
+bool i2c_master_writeRegisterBytes(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t* data, const uint8_t count) {
+    return model_transfer(deviceAddress, registerAddress, data, count);
+}
+
+bool i2c_master_writeRegisterZeroBytes(const uint8_t deviceAddress, const uint8_t registerAddress, const uint8_t zeroCount) {
+    return model_transfer(deviceAddress, registerAddress, NULL, zeroCount);
+}
+
+bool i2c_master_writeBytes(const uint8_t deviceAddress, const uint8_t* data, const uint8_t count) {
+    return i2c_master_writeRegisterBytes(deviceAddress, *data, data + 1, count - 1);
+}
+
+bool i2c_master_writeZeroBytes(const uint8_t deviceAddress, const uint8_t zeroCount) {
+    return i2c_master_writeRegisterZeroBytes(deviceAddress, 0, zeroCount - 1);
+}
@@ -0,0 +1,47 @@
+/* Josip Medved <jmedved@jmedved.com> * www.medo64.com * MIT License */
+
+/**
+ * SSD1306 panel model sitting behind the I2C master API.
+ *
+ * Implements the functions from i2c_master.h and spi_master.h so that
+ * unmodified ssd1306.c can drive it over either transport. Every transaction
+ * is charged for its bus time at the rate given to i2c_master_init or
+ * spi_master_init and can be recorded as a byte stream.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+/** Sets panel address and per-byte firmware overhead (in ns). */
+void model_init(const uint8_t address, const uint32_t byteOverheadNs);
+
+/** Records every transaction (transport, address, command or data, and bytes) as a line; NULL stops. */
+void model_setLog(FILE* log);
+
+/** Makes panel NAK everything above given clock (in Hz); 0 removes the limit. */
+void model_setClockLimit(const uint32_t clockLimit);
+
+/** Disconnects panel (everything is NAKed) or connects it again as if just powered up. */
+void model_setConnected(const bool connected);
+
+/** Returns true if panel is connected. */
+bool model_isConnected(void);
+
+/** Returns total time spent on I2C bus (in ns). */
+uint64_t model_getBusTime(void);
+
+/** Returns total number of bytes transferred over I2C. */
+uint64_t model_getBusBytes(void);
+
+/** Returns current I2C clock (in Hz). */
+uint32_t model_getBusClock(void);
+
+/** Returns true if SPI was initialized last. */
+bool model_isSpi(void);
+
+/** Writes panel content as text. */
+void model_dump(FILE* output, const uint8_t height);